@@ -0,0 +1,107 @@
+/*
+  ArduinoSecureElement - Base64 Benchmark
+
+  This sketch measures base64url encoding throughput of:
+  - a character by character String encoder (the previous implementation)
+  - b64::urlEncode() returning a String
+  - b64::urlEncode() writing into a caller provided buffer
+
+  Only MCU work is measured, the secure element is not accessed.
+
+  The circuit:
+  - Any board supported by the library
+
+  This example code is in the public domain.
+*/
+
+#include <Arduino_SecureElement.h>
+#include <utility/SElementBase64.h>
+
+const unsigned int INPUT_LENGTH = 512;
+const int ITERATIONS = 50;
+
+byte input[INPUT_LENGTH];
+char output[((4 * INPUT_LENGTH) + 2) / 3 + 1];
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial);
+
+  for (unsigned int i = 0; i < INPUT_LENGTH; i++) {
+    input[i] = i * 7;
+  }
+
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    String s = referenceUrlEncode(input, INPUT_LENGTH);
+  }
+  unsigned long referenceTime = micros() - start;
+
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    String s = b64::urlEncode(input, INPUT_LENGTH);
+  }
+  unsigned long stringTime = micros() - start;
+
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    b64::urlEncode(input, (size_t)INPUT_LENGTH, output, sizeof(output));
+  }
+  unsigned long bufferTime = micros() - start;
+
+  if (referenceUrlEncode(input, INPUT_LENGTH) != String(output)) {
+    Serial.println("Encoders output differ!");
+    while (1);
+  }
+
+  printThroughput("Per character String ", referenceTime);
+  printThroughput("b64::urlEncode String", stringTime);
+  printThroughput("b64::urlEncode buffer", bufferTime);
+}
+
+void loop() {
+  // do nothing
+}
+
+void printThroughput(const char* name, unsigned long time) {
+  Serial.print(name);
+  Serial.print(" [kB/s] = ");
+  Serial.println((unsigned long)((1000.0 * INPUT_LENGTH * ITERATIONS) / time));
+}
+
+String referenceUrlEncode(const byte in[], unsigned int length) {
+  static const char* CODES = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_=";
+
+  int b;
+  String out;
+
+  out.reserve(4 * ((length + 2) / 3));
+
+  for (unsigned int i = 0; i < length; i += 3) {
+    b = (in[i] & 0xFC) >> 2;
+    out += CODES[b];
+
+    b = (in[i] & 0x03) << 4;
+    if (i + 1 < length) {
+      b |= (in[i + 1] & 0xF0) >> 4;
+      out += CODES[b];
+      b = (in[i + 1] & 0x0F) << 2;
+      if (i + 2 < length) {
+         b |= (in[i + 2] & 0xC0) >> 6;
+         out += CODES[b];
+         b = in[i + 2] & 0x3F;
+         out += CODES[b];
+      } else {
+        out += CODES[b];
+      }
+    } else {
+      out += CODES[b];
+    }
+  }
+
+  while (out.lastIndexOf('=') != -1) {
+    out.remove(out.length() - 1);
+  }
+
+  return out;
+}
@@ -0,0 +1,103 @@
+/*
+  ArduinoSecureElement - Certificate Reconstruction Benchmark
+
+  This sketch measures how long it takes to rebuild an Arduino Cloud
+  device certificate DER from its compressed form, comparing the
+  generic certificate builder with the Arduino Cloud DER template.
+
+  Only MCU work is measured: synthetic certificate data is used and
+  the secure element is not accessed.
+
+  The circuit:
+  - Any board supported by the library
+
+  This example code is in the public domain.
+*/
+
+#include <Arduino_SecureElement.h>
+#include <utility/SElementArduinoCloudCertificate.h>
+
+const int ITERATIONS = 200;
+
+byte publicKey[ECP256_CERT_PUBLIC_KEY_LENGTH];
+byte serialNumber[ECP256_CERT_SERIAL_NUMBER_LENGTH];
+byte authorityKeyId[ECP256_CERT_AUTHORITY_KEY_ID_LENGTH];
+byte signature[ECP256_CERT_SIGNATURE_LENGTH];
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial);
+
+  for (unsigned int i = 0; i < sizeof(publicKey); i++) {
+    publicKey[i] = i + 1;
+  }
+  for (unsigned int i = 0; i < sizeof(serialNumber); i++) {
+    serialNumber[i] = 0x40 + i;
+  }
+  for (unsigned int i = 0; i < sizeof(authorityKeyId); i++) {
+    authorityKeyId[i] = 0xA0 + i;
+  }
+  for (unsigned int i = 0; i < sizeof(signature); i++) {
+    signature[i] = 0x10 + i;
+  }
+
+  ECP256Certificate genericCert;
+  ECP256Certificate templateCert;
+
+  fillCompressedData(genericCert);
+  fillCompressedData(templateCert);
+
+  /* Issuer names are set once, only the DER building is timed */
+  if (!genericCert.setIssuerCountryName("US") ||
+      !genericCert.setIssuerOrganizationName("Arduino LLC US") ||
+      !genericCert.setIssuerOrganizationalUnitName("IT") ||
+      !genericCert.setIssuerCommonName("Arduino")) {
+    Serial.println("Error setting the issuer names!");
+    while (1);
+  }
+
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    genericCert.setPublicKey(publicKey, sizeof(publicKey));
+    genericCert.buildCert();
+    genericCert.signCert();
+  }
+  unsigned long genericTime = micros() - start;
+
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    SElementArduinoCloudCertificate::reconstruct(templateCert, publicKey);
+    templateCert.bytes();
+  }
+  unsigned long templateTime = micros() - start;
+
+  if (genericCert.length() != templateCert.length() ||
+      memcmp(genericCert.bytes(), templateCert.bytes(), genericCert.length()) != 0) {
+    Serial.println("Template and generic builder output differ!");
+    while (1);
+  }
+
+  Serial.print("Certificate length = ");
+  Serial.println(genericCert.length());
+  Serial.print("Generic builder  [us/cert] = ");
+  Serial.println(genericTime / ITERATIONS);
+  Serial.print("DER template     [us/cert] = ");
+  Serial.println(templateTime / ITERATIONS);
+}
+
+void loop() {
+  // do nothing
+}
+
+void fillCompressedData(ECP256Certificate & cert) {
+  cert.begin();
+  cert.setSubjectCommonName("01234567-89ab-cdef-0123-456789abcdef");
+  cert.setSerialNumber(serialNumber, sizeof(serialNumber));
+  cert.setAuthorityKeyId(authorityKeyId, sizeof(authorityKeyId));
+  cert.setSignature(signature, sizeof(signature));
+  cert.setIssueYear(2024);
+  cert.setIssueMonth(5);
+  cert.setIssueDay(6);
+  cert.setIssueHour(7);
+  cert.setExpireYears(31);
+}
@@ -0,0 +1,120 @@
+/*
+  ArduinoSecureElement - JWS Verify Benchmark
+
+  This sketch signs an ES256 token with the private key stored in
+  slot 0 and measures how many tokens per second SElementJWS::verify()
+  can check against the matching public key, with and without a
+  SElementVerifyCache attached to the SecureElement, and with
+  verifications routed to the SElementP256 software verifier.
+
+  The secure element must already be configured and locked and slot 0
+  must hold a private key, see the CertificateSigningRequest example.
+
+  The circuit:
+  - A board equipped with ECC508 or ECC608 or SE050 chip or an UNO R4 WiFi
+
+  This example code is in the public domain.
+*/
+
+#include <Arduino_SecureElement.h>
+#include <utility/SElementJWS.h>
+#include <utility/SElementVerifyCache.h>
+#include <utility/SElementP256.h>
+
+const int KEY_SLOT = 0;
+const int ITERATIONS = 20;
+
+const char HEADER[] = "{\"alg\":\"ES256\",\"typ\":\"JWT\"}";
+const char PAYLOAD[] = "{\"iat\":1700000000,\"iss\":\"gateway\",\"sub\":\"benchmark\"}";
+
+SecureElement secureElement;
+SElementJWS jws;
+SElementVerifyCache verifyCache;
+SElementP256 softwareVerifier;
+
+byte publicKey[64];
+char token[256];
+size_t tokenLength;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial);
+
+  if (!secureElement.begin()) {
+    Serial.println("No SecureElement present!");
+    while (1);
+  }
+
+  if (!secureElement.locked()) {
+    Serial.println("The SecureElement is not locked!");
+    while (1);
+  }
+
+  if (!secureElement.generatePublicKey(KEY_SLOT, publicKey)) {
+    Serial.println("Error reading the public key!");
+    while (1);
+  }
+
+  tokenLength = jws.sign(secureElement, KEY_SLOT, HEADER, PAYLOAD, token, sizeof(token));
+  if (!tokenLength) {
+    Serial.println("Error signing the token!");
+    while (1);
+  }
+
+  Serial.println(token);
+  Serial.println();
+
+  printRate("Verify                  ", benchmark());
+
+  secureElement.setVerifyCache(&verifyCache);
+  printRate("Verify, verify cache on ", benchmark());
+  secureElement.setVerifyCache(nullptr);
+
+  unsigned long start = micros();
+  softwareVerifier.begin();
+  Serial.print("Software generator table [us] = ");
+  Serial.println(micros() - start);
+
+  secureElement.setVerifyPolicy(SecureElement::VerifyPolicy::Software, &softwareVerifier);
+  printRate("Verify, software        ", benchmark());
+
+  start = micros();
+  softwareVerifier.setTrustedKey(publicKey);
+  Serial.print("Software trusted key table [us] = ");
+  Serial.println(micros() - start);
+
+  printRate("Verify, software trusted", benchmark());
+  secureElement.setVerifyPolicy(SecureElement::VerifyPolicy::Chip);
+
+  /* Decoding header and payload modifies the token, so do it last */
+  SElementJWSView view;
+  if (!jws.verify(secureElement, publicKey, token, tokenLength, &view)) {
+    Serial.println("Error verifying the token!");
+    while (1);
+  }
+
+  Serial.println();
+  Serial.println(view.header);
+  Serial.println(view.payload);
+}
+
+void loop() {
+  // do nothing
+}
+
+unsigned long benchmark() {
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    if (!jws.verify(secureElement, publicKey, token, tokenLength)) {
+      Serial.println("Error verifying the token!");
+      while (1);
+    }
+  }
+  return micros() - start;
+}
+
+void printRate(const char* name, unsigned long time) {
+  Serial.print(name);
+  Serial.print(" [tokens/s] = ");
+  Serial.println((1000000.0 * ITERATIONS) / time);
+}
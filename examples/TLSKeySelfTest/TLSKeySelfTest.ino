@@ -0,0 +1,135 @@
+/*
+  SecureElement TLS Key Self Test
+
+  This sketch checks the TLS stack glue of SElementTLSKey without a network:
+  a hash is signed through the TLS library API with the private key stored
+  in the SecureElement, and the signature is verified in software by the
+  same TLS library.
+
+  mbedTLS 2.x is used on boards whose core provides it, BearSSL on SAMD
+  boards through the ArduinoBearSSL library.
+
+  If the SecureElement is not configured and locked the ConfigurationLocking
+  example should be used before running this sketch to setup the chip with a
+  default TLS configuration.
+
+  Circuit:
+   - A board equipped with ECC508 or ECC608 or SE050 chip
+
+  This example code is in the public domain.
+*/
+
+#include <Arduino_SecureElement.h>
+#if defined(ARDUINO_ARCH_SAMD)
+  #include <ArduinoBearSSL.h>
+#endif
+#include <utility/SElementTLSKey.h>
+
+const int keySlot = 0;
+
+SecureElement secureElement;
+SElementTLSKey tlsKey(secureElement, keySlot);
+
+#if defined(SE_TLS_KEY_BEARSSL) && !defined(SE_TLS_KEY_MBEDTLS)
+br_ssl_client_context sslClient;
+#endif
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial);
+
+  if (!secureElement.begin()) {
+    Serial.println("Failed to communicate with SecureElement!");
+    while (1);
+  }
+
+  if (!secureElement.locked()) {
+    Serial.println("The SecureElement is not locked!");
+    while (1);
+  }
+
+  if (!tlsKey.begin()) {
+    Serial.println("Error reading the public key!");
+    while (1);
+  }
+
+  const char message[] = "SElementTLSKey self test";
+  byte hash[32];
+
+  if (!secureElement.SHA256((const uint8_t*)message, strlen(message), hash)) {
+    Serial.println("Error computing the hash!");
+    while (1);
+  }
+
+#if defined(SE_TLS_KEY_MBEDTLS)
+  Serial.println("Testing the mbedTLS opaque key");
+
+  mbedtls_pk_context key;
+  mbedtls_pk_context reference;
+  unsigned char signature[SE_TLS_KEY_DER_SIGNATURE_MAX_LENGTH];
+  size_t signatureLength = 0;
+
+  mbedtls_pk_init(&key);
+  mbedtls_pk_init(&reference);
+
+  if (!tlsKey.setupMbedTLS(&key)) {
+    Serial.println("Error setting up the mbedTLS key!");
+    while (1);
+  }
+
+  if (mbedtls_pk_sign(&key, MBEDTLS_MD_SHA256, hash, sizeof(hash), signature, &signatureLength, nullptr, nullptr) != 0) {
+    Serial.println("mbedtls_pk_sign() failed!");
+    while (1);
+  }
+
+  /* Software key holding only the public key read back with mbedtls_pk_ec() */
+  if (mbedtls_pk_setup(&reference, mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY)) != 0 ||
+      mbedtls_ecp_group_copy(&mbedtls_pk_ec(reference)->grp, &mbedtls_pk_ec(key)->grp) != 0 ||
+      mbedtls_ecp_copy(&mbedtls_pk_ec(reference)->Q, &mbedtls_pk_ec(key)->Q) != 0) {
+    Serial.println("Error setting up the reference key!");
+    while (1);
+  }
+
+  if (mbedtls_pk_verify(&reference, MBEDTLS_MD_SHA256, hash, sizeof(hash), signature, signatureLength) != 0) {
+    Serial.println("Signature rejected by mbedTLS!");
+    while (1);
+  }
+
+  mbedtls_pk_free(&reference);
+  mbedtls_pk_free(&key);
+  Serial.println("mbedTLS signature verified");
+#elif defined(SE_TLS_KEY_BEARSSL)
+  Serial.println("Testing the BearSSL signing key");
+
+  const br_ssl_client_certificate_ec_context & auth = sslClient.client_auth.single_ec;
+  unsigned char signature[SE_TLS_KEY_DER_SIGNATURE_MAX_LENGTH];
+  unsigned char point[1 + 64];
+  br_ec_public_key publicKey = { BR_EC_secp256r1, point, sizeof(point) };
+
+  br_ssl_client_zero(&sslClient);
+  tlsKey.setupBearSSLClient(&sslClient, nullptr, 0, BR_KEYTYPE_EC);
+
+  /* The same call BearSSL makes for the CertificateVerify message */
+  size_t signatureLength = auth.iecdsa(auth.iec, &br_sha256_vtable, hash, auth.sk, signature);
+  if (signatureLength == 0) {
+    Serial.println("BearSSL sign callback failed!");
+    while (1);
+  }
+
+  point[0] = 0x04;
+  memcpy(&point[1], tlsKey.publicKey(), 64);
+
+  if (!br_ecdsa_i31_vrfy_asn1(br_ec_get_default(), hash, sizeof(hash), &publicKey, signature, signatureLength)) {
+    Serial.println("Signature rejected by BearSSL!");
+    while (1);
+  }
+
+  Serial.println("BearSSL signature verified");
+#else
+  Serial.println("No supported TLS library on this board");
+#endif
+}
+
+void loop() {
+
+}
@@ -0,0 +1,151 @@
+/*
+  ArduinoSecureElement - Time To Credential Benchmark
+
+  This sketch runs the sequence an Arduino Cloud device goes through
+  at boot before it can connect, and prints how long each phase takes:
+  - SecureElement begin
+  - device id read
+  - certificate read
+  - signature compare with the metadata received from the cloud
+  - certificate rebuild, as done when the cloud metadata differs
+  - JWT generation
+
+  The total includes the rebuild, so it is the worst case boot.
+
+  On ARM boards the heap arena reported by mallinfo() is printed as
+  well: the memory the heap obtained from the system with sbrk(), which
+  newlib does not give back, so an upper bound of the heap peak rather
+  than the peak itself.
+
+  The board must already be provisioned for Arduino Cloud: slots are
+  only read, nothing is written to the secure element.
+
+  The circuit:
+  - A board equipped with ECC508 or ECC608 or SE050 chip or an UNO R4 WiFi
+
+  This example code is in the public domain.
+*/
+
+#include <Arduino_SecureElement.h>
+#include <utility/SElementArduinoCloudCertificate.h>
+#include <utility/SElementArduinoCloudDeviceId.h>
+#include <utility/SElementArduinoCloudJWT.h>
+
+#if defined(__arm__) && __has_include(<malloc.h>)
+  #include <malloc.h>
+  #define HAS_MALLINFO
+#endif
+
+/* Synthetic metadata used to time a rebuild, the result is never stored */
+const char NOT_BEFORE[] = "2024-05-06T07:00:00Z";
+const char NOT_AFTER[] = "2054-05-06T07:00:00Z";
+const char SERIAL_NUMBER[] = "0102030405060708090a0b0c0d0e0f10";
+const char AUTHORITY_KEY_ID[] = "0102030405060708090a0b0c0d0e0f1011121314";
+const uint64_t JWT_IAT = 1700000000;
+
+SecureElement secureElement;
+
+unsigned long phaseStart;
+unsigned long totalTime;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial);
+
+  totalTime = 0;
+
+  beginPhase();
+  if (!secureElement.begin()) {
+    Serial.println("No SecureElement present!");
+    while (1);
+  }
+  endPhase("begin                ");
+
+  String deviceId;
+  beginPhase();
+  if (!SElementArduinoCloudDeviceId::read(secureElement, deviceId, SElementArduinoCloudSlot::DeviceId)) {
+    Serial.println("Error reading the device id!");
+    while (1);
+  }
+  endPhase("device id read       ");
+
+  ECP256Certificate cert;
+  beginPhase();
+  if (!SElementArduinoCloudCertificate::read(secureElement, cert, SElementArduinoCloudSlot::CompressedCertificate)) {
+    Serial.println("Error reading the certificate!");
+    while (1);
+  }
+  /* Certificates rebuilt from compressed data are built on first access */
+  if (cert.bytes() == nullptr) {
+    Serial.println("Error building the certificate!");
+    while (1);
+  }
+  endPhase("certificate read     ");
+
+  String signature = toHex(cert.signatureBytes(), ECP256_CERT_SIGNATURE_LENGTH);
+  beginPhase();
+  int compare = SElementArduinoCloudCertificate::signatureCompare(cert.signatureBytes(), signature);
+  endPhase("signature compare    ");
+
+  if (compare != 0) {
+    Serial.println("Error comparing the signature!");
+    while (1);
+  }
+
+  ECP256Certificate rebuilt;
+  beginPhase();
+  if (SElementArduinoCloudCertificate::rebuild(secureElement, rebuilt, deviceId, NOT_BEFORE, NOT_AFTER,
+                                               SERIAL_NUMBER, AUTHORITY_KEY_ID, signature) != 1) {
+    Serial.println("Error rebuilding the certificate!");
+    while (1);
+  }
+  endPhase("certificate rebuild  ");
+
+  beginPhase();
+  String jwt = getAIoTCloudJWT(secureElement, deviceId, JWT_IAT, static_cast<int>(SElementArduinoCloudSlot::Key));
+  endPhase("JWT                  ");
+
+  if (jwt.length() == 0) {
+    Serial.println("Error generating the JWT!");
+    while (1);
+  }
+
+  Serial.print("time to credential    [ms] = ");
+  Serial.println(totalTime / 1000.0);
+
+#if defined(HAS_MALLINFO)
+  struct mallinfo info = mallinfo();
+  Serial.print("heap arena (sbrk)  [bytes] = ");
+  Serial.println(info.arena);
+  Serial.print("heap in use        [bytes] = ");
+  Serial.println(info.uordblks);
+#endif
+}
+
+void loop() {
+  // do nothing
+}
+
+void beginPhase() {
+  phaseStart = micros();
+}
+
+void endPhase(const char* name) {
+  unsigned long time = micros() - phaseStart;
+  totalTime += time;
+  Serial.print(name);
+  Serial.print(" [ms] = ");
+  Serial.println(time / 1000.0);
+}
+
+String toHex(const byte in[], int length) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  String out;
+
+  out.reserve(2 * length);
+  for (int i = 0; i < length; i++) {
+    out += HEX_DIGITS[in[i] >> 4];
+    out += HEX_DIGITS[in[i] & 0x0F];
+  }
+  return out;
+}
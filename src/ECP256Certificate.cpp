@@ -30,6 +30,48 @@
 #define ASN1_SEQUENCE          0x30
 #define ASN1_SET               0x31
 
+#define PEM_KIND_NONE          0
+#define PEM_KIND_CSR           1
+#define PEM_KIND_CERT          2
+
+#define NAME_INDEX(name)       static_cast<int>(ECP256Certificate::Name::name)
+
+/******************************************************************************
+ * LOCAL MODULE CONSTANTS
+ ******************************************************************************/
+
+/* X.520 attribute types, in ECP256Certificate::Name order */
+static const byte NAME_ATTRIBUTE_TYPE[ECP256_CERT_NAME_COUNT] = {
+  0x06, /* countryName */
+  0x08, /* stateOrProvinceName */
+  0x07, /* localityName */
+  0x0a, /* organizationName */
+  0x0b, /* organizationalUnitName */
+  0x03  /* commonName */
+};
+
+/* Constant DER fragments used by buildCertFromTemplate() */
+static const byte TEMPLATE_VERSION[] = {
+  0xA0, 0x03, 0x02, 0x01, 0x02
+};
+
+static const byte TEMPLATE_ECDSA_WITH_SHA256[] = {
+  ASN1_SEQUENCE, 0x0A, ASN1_OBJECT_IDENTIFIER, 0x08, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x04, 0x03, 0x02
+};
+
+static const byte TEMPLATE_PUBLIC_KEY_HEADER[] = {
+  ASN1_SEQUENCE, 0x59, ASN1_SEQUENCE, 0x13,
+  ASN1_OBJECT_IDENTIFIER, 0x07, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x02, 0x01,
+  ASN1_OBJECT_IDENTIFIER, 0x08, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x03, 0x01, 0x07,
+  ASN1_BIT_STRING, 0x42, 0x00, 0x04
+};
+
+static const byte TEMPLATE_AUTHORITY_KEY_ID_HEADER[] = {
+  0xA3, 0x23, ASN1_SEQUENCE, 0x21, ASN1_SEQUENCE, 0x1F,
+  ASN1_OBJECT_IDENTIFIER, 0x03, 0x55, 0x1D, 0x23,
+  0x04, 0x18, ASN1_SEQUENCE, 0x16, 0x80, 0x14
+};
+
 /******************************************************************************
  * CTOR/DTOR
  ******************************************************************************/
@@ -37,13 +79,24 @@
 ECP256Certificate::ECP256Certificate()
 : _certBuffer(nullptr)
 , _certBufferLen(0)
-, _publicKey(nullptr)
+, _certDeferred(false)
+, _issuerTemplate(nullptr)
+, _issuerTemplateLen(0)
+, _pemKind(PEM_KIND_NONE)
+, _publicKeySet(false)
 {
+  memset(&_issuerData, 0x00, sizeof(_issuerData));
+  memset(&_subjectData, 0x00, sizeof(_subjectData));
 
 }
 
 ECP256Certificate::~ECP256Certificate() 
 {
+  for (int i = 0; i < ECP256_CERT_NAME_COUNT; i++) {
+    releaseName(_issuerData, i);
+    releaseName(_subjectData, i);
+  }
+
   if (_certBuffer) {
     free(_certBuffer);
     _certBuffer = nullptr;
@@ -65,10 +118,7 @@ int ECP256Certificate::buildCSR()
   int csrInfoLen = CSRInfoLength();
   int subjectLen = issuerOrSubjectLength(_subjectData);
 
-  _certBufferLen = getCSRSize();
-  _certBuffer = (byte*)malloc(_certBufferLen);
-
-  if (_certBuffer == nullptr) {
+  if (!allocCertBuffer(getCSRSize())) {
     return 0;
   }
 
@@ -85,7 +135,7 @@ int ECP256Certificate::buildCSR()
   out += appendIssuerOrSubject(_subjectData, out);
 
   // public key
-  if (_publicKey == nullptr) {
+  if (!_publicKeySet) {
     return 0;
   }
   out += appendPublicKey(_publicKey, out);
@@ -108,6 +158,7 @@ int ECP256Certificate::signCSR(byte * signature)
 
   memcpy(tempBuffer, _certBuffer, _certBufferLen);
   
+  _pemKind = PEM_KIND_NONE;
   _certBufferLen = getCSRSignedSize(signature);
   _certBuffer = (byte*)realloc(_certBuffer, _certBufferLen);
 
@@ -133,15 +184,14 @@ int ECP256Certificate::signCSR(byte * signature)
 
 String ECP256Certificate::getCSRPEM()
 {
-  return b64::pemEncode(_certBuffer, _certBufferLen, "-----BEGIN CERTIFICATE REQUEST-----\n", "\n-----END CERTIFICATE REQUEST-----\n");
+  return cachedPEM(PEM_KIND_CSR, "-----BEGIN CERTIFICATE REQUEST-----\n", "\n-----END CERTIFICATE REQUEST-----\n");
 }
 
 int ECP256Certificate::buildCert()
 {
-  _certBufferLen = getCertSize();
-  _certBuffer = (byte*)malloc(_certBufferLen);
+  _certDeferred = false;
 
-  if (_certBuffer == nullptr) {
+  if (!allocCertBuffer(getCertSize())) {
     return 0;
   }
   
@@ -185,7 +235,7 @@ int ECP256Certificate::buildCert()
   out += appendIssuerOrSubject(_subjectData, out);
 
   // public key
-  if (_publicKey == nullptr) {
+  if (!_publicKeySet) {
     return 0;
   }
   out += appendPublicKey(_publicKey, out);
@@ -218,6 +268,7 @@ int ECP256Certificate::signCert(const byte * signature)
 
   memcpy(tempBuffer, _certBuffer, _certBufferLen);
   
+  _pemKind = PEM_KIND_NONE;
   _certBufferLen = getCertSignedSize(signature);
   _certBuffer = (byte*)realloc(_certBuffer, _certBufferLen);
 
@@ -243,10 +294,9 @@ int ECP256Certificate::signCert(const byte * signature)
 
 int ECP256Certificate::importCert(const byte certDER[], size_t derLen)
 {
-  _certBufferLen = derLen;
-  _certBuffer = (byte*)malloc(_certBufferLen);
+  _certDeferred = false;
 
-  if (_certBuffer == nullptr) {
+  if (!allocCertBuffer(derLen)) {
     return 0;
   }
 
@@ -265,14 +315,161 @@ int ECP256Certificate::importCert(const byte certDER[], size_t derLen)
   return 1;
 }
 
+int ECP256Certificate::exportCompressedCert(byte out[], int outLen)
+{
+  int commonNameLen = _subjectData.length[NAME_INDEX(CommonName)];
+
+  if (outLen < ECP256_CERT_COMPRESSED_STORAGE_LENGTH || commonNameLen > ECP256_CERT_SUBJECT_COMMON_NAME_MAX_LENGTH) {
+    return 0;
+  }
+
+  memset(out, 0x00, ECP256_CERT_COMPRESSED_STORAGE_LENGTH);
+
+  *out++ = ECP256_CERT_COMPRESSED_STORAGE_VERSION;
+  memcpy(out, _compressedCert.data, ECP256_CERT_COMPRESSED_CERT_LENGTH);
+  out += ECP256_CERT_COMPRESSED_CERT_LENGTH;
+  *out++ = commonNameLen;
+  memcpy(out, _subjectData.value[NAME_INDEX(CommonName)], commonNameLen);
+
+  return ECP256_CERT_COMPRESSED_STORAGE_LENGTH;
+}
+
+int ECP256Certificate::importCompressedCert(const byte in[], int inLen)
+{
+  if (inLen < ECP256_CERT_COMPRESSED_STORAGE_LENGTH || in[0] != ECP256_CERT_COMPRESSED_STORAGE_VERSION) {
+    return 0;
+  }
+  in++;
+
+  memcpy(_compressedCert.data, in, ECP256_CERT_COMPRESSED_CERT_LENGTH);
+  in += ECP256_CERT_COMPRESSED_CERT_LENGTH;
+
+  int commonNameLen = *in++;
+  if (commonNameLen > ECP256_CERT_SUBJECT_COMMON_NAME_MAX_LENGTH) {
+    return 0;
+  }
+  return setSubjectName(Name::CommonName, (const char*)in, commonNameLen);
+}
+
+int ECP256Certificate::importCertPEM(char pem[], size_t pemLen)
+{
+  int derLen = b64::pemDecode(pem, pemLen, (byte*)pem, pemLen);
+
+  if (derLen <= 0) {
+    return 0;
+  }
+
+  return importCert((const byte*)pem, derLen);
+}
+
 int ECP256Certificate::signCert()
 {
   return signCert(_compressedCert.slot.one.values.signature);
 }
 
+int ECP256Certificate::deferBuildCert(const byte issuerTemplate[], int issuerTemplateLen)
+{
+  if (!_publicKeySet) {
+    return 0;
+  }
+
+  _issuerTemplate = issuerTemplate;
+  _issuerTemplateLen = issuerTemplateLen;
+  _certDeferred = true;
+  _pemKind = PEM_KIND_NONE;
+  return 1;
+}
+
+int ECP256Certificate::buildCertFromTemplate(const byte issuerTemplate[], int issuerTemplateLen)
+{
+  const byte * serialNumber = _compressedCert.slot.two.values.serialNumber;
+  const byte * authorityKeyId = _compressedCert.slot.two.values.authorityKeyId;
+  const byte * signature = _compressedCert.slot.one.values.signature;
+  int commonNameLen = _subjectData.length[NAME_INDEX(CommonName)];
+  DateInfo dateData;
+
+  getDateFromCompressedData(dateData);
+
+  if (!_publicKeySet || issuerTemplate == nullptr || dateData.issueYear > 2049 ||
+      commonNameLen == 0 || commonNameLen > ECP256_CERT_SUBJECT_COMMON_NAME_MAX_LENGTH ||
+      issuerOrSubjectLength(_subjectData) != (11 + commonNameLen) ||
+      !authorityKeyIdLength(authorityKeyId, ECP256_CERT_AUTHORITY_KEY_ID_LENGTH)) {
+    return 0;
+  }
+
+  int expireYear = dateData.issueYear + dateData.expireYears;
+  int datesLen = 30 + ((expireYear > 2049) ? 2 : 0);
+  int subjectLen = 11 + commonNameLen;
+  int certInfoLen = sizeof(TEMPLATE_VERSION) + serialNumberLength(serialNumber, ECP256_CERT_SERIAL_NUMBER_LENGTH) +
+                    sizeof(TEMPLATE_ECDSA_WITH_SHA256) + issuerTemplateLen + (2 + datesLen) +
+                    (2 + subjectLen) + publicKeyLength() + (sizeof(TEMPLATE_AUTHORITY_KEY_ID_HEADER) + ECP256_CERT_AUTHORITY_KEY_ID_LENGTH);
+  int certLen = sequenceHeaderLength(certInfoLen) + certInfoLen + signatureLength(signature);
+
+  _certDeferred = false;
+
+  if (!allocCertBuffer(sequenceHeaderLength(certLen) + certLen)) {
+    return 0;
+  }
+
+  byte* out = _certBuffer;
+
+  // headers
+  out += appendSequenceHeader(certLen, out);
+  out += appendSequenceHeader(certInfoLen, out);
+
+  memcpy(out, TEMPLATE_VERSION, sizeof(TEMPLATE_VERSION));
+  out += sizeof(TEMPLATE_VERSION);
+
+  out += appendSerialNumber(serialNumber, ECP256_CERT_SERIAL_NUMBER_LENGTH, out);
+
+  memcpy(out, TEMPLATE_ECDSA_WITH_SHA256, sizeof(TEMPLATE_ECDSA_WITH_SHA256));
+  out += sizeof(TEMPLATE_ECDSA_WITH_SHA256);
+
+  memcpy(out, issuerTemplate, issuerTemplateLen);
+  out += issuerTemplateLen;
+
+  // dates
+  *out++ = ASN1_SEQUENCE;
+  *out++ = datesLen;
+  out += appendDate(dateData.issueYear, dateData.issueMonth, dateData.issueDay, dateData.issueHour, 0, 0, out);
+  out += appendDate(expireYear, dateData.issueMonth, dateData.issueDay, dateData.issueHour, 0, 0, out);
+
+  // subject
+  *out++ = ASN1_SEQUENCE;
+  *out++ = subjectLen;
+  out += appendName(_subjectData.value[NAME_INDEX(CommonName)], commonNameLen, NAME_ATTRIBUTE_TYPE[NAME_INDEX(CommonName)], out);
+
+  memcpy(out, TEMPLATE_PUBLIC_KEY_HEADER, sizeof(TEMPLATE_PUBLIC_KEY_HEADER));
+  out += sizeof(TEMPLATE_PUBLIC_KEY_HEADER);
+  memcpy(out, _publicKey, ECP256_CERT_PUBLIC_KEY_LENGTH);
+  out += ECP256_CERT_PUBLIC_KEY_LENGTH;
+
+  memcpy(out, TEMPLATE_AUTHORITY_KEY_ID_HEADER, sizeof(TEMPLATE_AUTHORITY_KEY_ID_HEADER));
+  out += sizeof(TEMPLATE_AUTHORITY_KEY_ID_HEADER);
+  memcpy(out, authorityKeyId, ECP256_CERT_AUTHORITY_KEY_ID_LENGTH);
+  out += ECP256_CERT_AUTHORITY_KEY_ID_LENGTH;
+
+  appendSignature(signature, out);
+
+  return 1;
+}
+
 String ECP256Certificate::getCertPEM()
 {
-  return b64::pemEncode(_certBuffer, _certBufferLen, "-----BEGIN CERTIFICATE-----\n", "\n-----END CERTIFICATE-----\n");
+  materializeCert();
+  return cachedPEM(PEM_KIND_CERT, "-----BEGIN CERTIFICATE-----\n", "\n-----END CERTIFICATE-----\n");
+}
+
+byte* ECP256Certificate::bytes()
+{
+  materializeCert();
+  return _certBuffer;
+}
+
+int ECP256Certificate::length()
+{
+  materializeCert();
+  return _certBufferLen;
 }
 
 void ECP256Certificate::getDateFromCompressedData(DateInfo& date) {
@@ -330,9 +527,18 @@ int ECP256Certificate::setAuthorityKeyId(const uint8_t authorityKeyId[], int aut
   return 0;
 }
 
+int ECP256Certificate::setIssuerName(Name name, const char* value, int length, bool copy) {
+  return setName(_issuerData, name, value, length, copy);
+}
+
+int ECP256Certificate::setSubjectName(Name name, const char* value, int length, bool copy) {
+  return setName(_subjectData, name, value, length, copy);
+}
+
 int ECP256Certificate::setPublicKey(const byte* publicKey, int publicKeyLen) {
   if (publicKeyLen == ECP256_CERT_PUBLIC_KEY_LENGTH) {
-    _publicKey = publicKey;
+    memcpy(_publicKey, publicKey, ECP256_CERT_PUBLIC_KEY_LENGTH);
+    _publicKeySet = true;
     return 1;
   }
   return 0;
@@ -350,43 +556,139 @@ int ECP256Certificate::setSignature(const byte* signature, int signatureLen) {
  * PRIVATE MEMBER FUNCTIONS
  ******************************************************************************/
 
-int ECP256Certificate::versionLength()
+int ECP256Certificate::allocCertBuffer(int length)
 {
-  return 3;
+  if (_certBuffer) {
+    free(_certBuffer);
+  }
+
+  _pemKind = PEM_KIND_NONE;
+  _certBufferLen = length;
+  _certBuffer = (byte*)malloc(_certBufferLen);
+
+  if (_certBuffer == nullptr) {
+    _certBufferLen = 0;
+    return 0;
+  }
+  return 1;
 }
 
-int ECP256Certificate::issuerOrSubjectLength(const CertInfo& issuerOrSubjectData)
+void ECP256Certificate::materializeCert()
 {
-  int length                       = 0;
-  int countryNameLength            = issuerOrSubjectData.countryName.length();
-  int stateProvinceNameLength      = issuerOrSubjectData.stateProvinceName.length();
-  int localityNameLength           = issuerOrSubjectData.localityName.length();
-  int organizationNameLength       = issuerOrSubjectData.organizationName.length();
-  int organizationalUnitNameLength = issuerOrSubjectData.organizationalUnitName.length();
-  int commonNameLength             = issuerOrSubjectData.commonName.length();
+  if (!_certDeferred) {
+    return;
+  }
 
-  if (countryNameLength) {
-    length += (11 + countryNameLength);
+  if (_issuerTemplate && buildCertFromTemplate(_issuerTemplate, _issuerTemplateLen)) {
+    return;
   }
 
-  if (stateProvinceNameLength) {
-    length += (11 + stateProvinceNameLength);
+  if (!buildCert() || !signCert()) {
+    if (_certBuffer) {
+      free(_certBuffer);
+      _certBuffer = nullptr;
+    }
+    _certBufferLen = 0;
+  }
+}
+
+String ECP256Certificate::cachedPEM(byte kind, const char* prefix, const char* suffix)
+{
+  if (_certBuffer == nullptr) {
+    return "";
   }
 
-  if (localityNameLength) {
-    length += (11 + localityNameLength);
+  if (_pemKind != kind) {
+    _pem = b64::pemEncode(_certBuffer, _certBufferLen, prefix, suffix);
+    _pemKind = kind;
   }
+  return _pem;
+}
 
-  if (organizationNameLength) {
-    length += (11 + organizationNameLength);
+int ECP256Certificate::setName(CertInfo& info, Name name, const char* value, int length, bool copy)
+{
+  int index = static_cast<int>(name);
+  char tmp[0x7f - 9];
+
+  /* The name SET must fit a DER short form length */
+  if (value != nullptr && length > (int)sizeof(tmp)) {
+    return 0;
   }
 
-  if (organizationalUnitNameLength) {
-    length += (11 + organizationalUnitNameLength);
+  /* releaseName() moves or frees the old copy, value may point into it */
+  if (copy && value != nullptr && length > 0) {
+    memcpy(tmp, value, length);
+    value = tmp;
   }
 
-  if (commonNameLength) {
-    length += (11 + commonNameLength);
+  releaseName(info, index);
+
+  if (value == nullptr || length <= 0) {
+    return 1;
+  }
+
+  if (copy && length <= (int)sizeof(info.buffer) - info.used) {
+    memcpy(&info.buffer[info.used], value, length);
+    value = &info.buffer[info.used];
+    info.used += length;
+  } else if (copy) {
+    char* heapValue = (char*)malloc(length);
+    if (heapValue == nullptr) {
+      return 0;
+    }
+    memcpy(heapValue, value, length);
+    value = heapValue;
+    info.heap |= (1 << index);
+  }
+
+  info.value[index] = value;
+  info.length[index] = length;
+  return 1;
+}
+
+void ECP256Certificate::releaseName(CertInfo& info, int index)
+{
+  const char* value = info.value[index];
+  int length = info.length[index];
+
+  info.value[index] = nullptr;
+  info.length[index] = 0;
+
+  if (info.heap & (1 << index)) {
+    free((void*)value);
+    info.heap &= ~(1 << index);
+    return;
+  }
+
+  if (value < info.buffer || value >= &info.buffer[sizeof(info.buffer)]) {
+    return;
+  }
+
+  /* Compact the buffer and move the names stored after the released one */
+  int offset = value - info.buffer;
+  memmove(&info.buffer[offset], &info.buffer[offset + length], info.used - offset - length);
+  info.used -= length;
+
+  for (int i = 0; i < ECP256_CERT_NAME_COUNT; i++) {
+    if (info.value[i] > value && info.value[i] < &info.buffer[sizeof(info.buffer)]) {
+      info.value[i] -= length;
+    }
+  }
+}
+
+int ECP256Certificate::versionLength()
+{
+  return 3;
+}
+
+int ECP256Certificate::issuerOrSubjectLength(const CertInfo& issuerOrSubjectData)
+{
+  int length = 0;
+
+  for (int i = 0; i < ECP256_CERT_NAME_COUNT; i++) {
+    if (issuerOrSubjectData.length[i]) {
+      length += (11 + issuerOrSubjectData.length[i]);
+    }
   }
 
   return length;
@@ -582,10 +884,8 @@ int ECP256Certificate::appendVersion(int version, byte out[])
   return versionLength();
 }
 
-int ECP256Certificate::appendName(const String& name, int type, byte out[])
+int ECP256Certificate::appendName(const char* name, int nameLength, int type, byte out[])
 {
-  int nameLength = name.length();
-
   *out++ = ASN1_SET;
   *out++ = nameLength + 9;
 
@@ -600,35 +900,17 @@ int ECP256Certificate::appendName(const String& name, int type, byte out[])
 
   *out++ = ASN1_PRINTABLE_STRING;
   *out++ = nameLength;
-  memcpy(out, name.c_str(), nameLength);
+  memcpy(out, name, nameLength);
 
   return (nameLength + 11);
 }
 
 int ECP256Certificate::appendIssuerOrSubject(const CertInfo& issuerOrSubjectData, byte out[])
 {
-  if (issuerOrSubjectData.countryName.length() > 0) {
-    out += appendName(issuerOrSubjectData.countryName, 0x06, out);
-  }
-
-  if (issuerOrSubjectData.stateProvinceName.length() > 0) {
-    out += appendName(issuerOrSubjectData.stateProvinceName, 0x08, out);
-  }
-
-  if (issuerOrSubjectData.localityName.length() > 0) {
-    out += appendName(issuerOrSubjectData.localityName, 0x07, out);
-  }
-
-  if (issuerOrSubjectData.organizationName.length() > 0) {
-    out += appendName(issuerOrSubjectData.organizationName, 0x0a, out);
-  }
-
-  if (issuerOrSubjectData.organizationalUnitName.length() > 0) {
-    out += appendName(issuerOrSubjectData.organizationalUnitName, 0x0b, out);
-  }
-
-  if (issuerOrSubjectData.commonName.length() > 0) {
-    out += appendName(issuerOrSubjectData.commonName, 0x03, out);
+  for (int i = 0; i < ECP256_CERT_NAME_COUNT; i++) {
+    if (issuerOrSubjectData.length[i] > 0) {
+      out += appendName(issuerOrSubjectData.value[i], issuerOrSubjectData.length[i], NAME_ATTRIBUTE_TYPE[i], out);
+    }
   }
 
   return issuerOrSubjectLength(issuerOrSubjectData);
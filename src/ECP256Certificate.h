@@ -28,6 +28,16 @@
 #define ECP256_CERT_DATES_LENGTH                     3
 #define ECP256_CERT_COMPRESSED_CERT_SLOT_LENGTH     72
 #define ECP256_CERT_COMPRESSED_CERT_LENGTH          (ECP256_CERT_COMPRESSED_CERT_SLOT_LENGTH + ECP256_CERT_SERIAL_NUMBER_LENGTH + ECP256_CERT_AUTHORITY_KEY_ID_LENGTH)
+#define ECP256_CERT_SUBJECT_COMMON_NAME_MAX_LENGTH  64
+#define ECP256_CERT_COMPRESSED_STORAGE_VERSION      0x01
+#define ECP256_CERT_COMPRESSED_STORAGE_LENGTH       (1 + ECP256_CERT_COMPRESSED_CERT_LENGTH + 1 + ECP256_CERT_SUBJECT_COMMON_NAME_MAX_LENGTH)
+#define ECP256_CERT_NAME_COUNT                       6
+/* Inline storage for copied issuer or subject names, each side has its own.
+ * Names that do not fit are copied to the heap instead.
+ */
+#ifndef ECP256_CERT_NAME_BUFFER_LENGTH
+  #define ECP256_CERT_NAME_BUFFER_LENGTH            96
+#endif
 
 #include <Arduino.h>
 
@@ -48,40 +58,64 @@ public:
   int setSerialNumber(const uint8_t serialNumber[], int serialNumberLen);
   int setAuthorityKeyId(const uint8_t authorityKeyId[], int authorityKeyIdLen);
 
-  inline void setIssuerCountryName(const String& countryName) { _issuerData.countryName = countryName; }
-  inline void setIssuerStateProvinceName(const String& stateProvinceName) { _issuerData.stateProvinceName = stateProvinceName; }
-  inline void setIssuerLocalityName(const String& localityName) { _issuerData.localityName = localityName; }
-  inline void setIssuerOrganizationName(const String& organizationName) { _issuerData.organizationName = organizationName; }
-  inline void setIssuerOrganizationalUnitName(const String& organizationalUnitName) { _issuerData.organizationalUnitName = organizationalUnitName; }
-  inline void setIssuerCommonName(const String& commonName) { _issuerData.commonName = commonName; }
+  enum class Name : byte
+  {
+    CountryName = 0,
+    StateProvinceName,
+    LocalityName,
+    OrganizationName,
+    OrganizationalUnitName,
+    CommonName
+  };
+
+  /* Names are copied into the certificate inline buffer, or to the heap
+   * once it is full. With copy = false only the pointer is kept and value
+   * must outlive the certificate (string literals, constants in flash).
+   * Returns 0 if the name is longer than a DER name allows or the heap is
+   * exhausted, the name is then left unset.
+   */
+  int setIssuerName(Name name, const char* value, int length, bool copy = true);
+  int setSubjectName(Name name, const char* value, int length, bool copy = true);
+
+  inline int setIssuerCountryName(const String& countryName) { return setIssuerName(Name::CountryName, countryName.c_str(), countryName.length()); }
+  inline int setIssuerStateProvinceName(const String& stateProvinceName) { return setIssuerName(Name::StateProvinceName, stateProvinceName.c_str(), stateProvinceName.length()); }
+  inline int setIssuerLocalityName(const String& localityName) { return setIssuerName(Name::LocalityName, localityName.c_str(), localityName.length()); }
+  inline int setIssuerOrganizationName(const String& organizationName) { return setIssuerName(Name::OrganizationName, organizationName.c_str(), organizationName.length()); }
+  inline int setIssuerOrganizationalUnitName(const String& organizationalUnitName) { return setIssuerName(Name::OrganizationalUnitName, organizationalUnitName.c_str(), organizationalUnitName.length()); }
+  inline int setIssuerCommonName(const String& commonName) { return setIssuerName(Name::CommonName, commonName.c_str(), commonName.length()); }
 
   /* APIs used for both CSR and Certificate generation */
-  inline void setSubjectCountryName(const String& countryName) { _subjectData.countryName = countryName; }
-  inline void setSubjectStateProvinceName(const String& stateProvinceName) { _subjectData.stateProvinceName = stateProvinceName; }
-  inline void setSubjectLocalityName(const String& localityName) { _subjectData.localityName = localityName; }
-  inline void setSubjectOrganizationName(const String& organizationName) { _subjectData.organizationName = organizationName; }
-  inline void setSubjectOrganizationalUnitName(const String& organizationalUnitName) { _subjectData.organizationalUnitName = organizationalUnitName; }
-  inline void setSubjectCommonName(const String& commonName) { _subjectData.commonName = commonName; }
+  inline int setSubjectCountryName(const String& countryName) { return setSubjectName(Name::CountryName, countryName.c_str(), countryName.length()); }
+  inline int setSubjectStateProvinceName(const String& stateProvinceName) { return setSubjectName(Name::StateProvinceName, stateProvinceName.c_str(), stateProvinceName.length()); }
+  inline int setSubjectLocalityName(const String& localityName) { return setSubjectName(Name::LocalityName, localityName.c_str(), localityName.length()); }
+  inline int setSubjectOrganizationName(const String& organizationName) { return setSubjectName(Name::OrganizationName, organizationName.c_str(), organizationName.length()); }
+  inline int setSubjectOrganizationalUnitName(const String& organizationalUnitName) { return setSubjectName(Name::OrganizationalUnitName, organizationalUnitName.c_str(), organizationalUnitName.length()); }
+  inline int setSubjectCommonName(const String& commonName) { return setSubjectName(Name::CommonName, commonName.c_str(), commonName.length()); }
 
   int setPublicKey(const byte* publicKey, int publicKeyLen);
   int setSignature(const byte* signature, int signatureLen);
 
-  /* Get Buffer */
-  inline byte* bytes() { return _certBuffer; }
-  inline int length() { return _certBufferLen; }
+  /* Get Buffer, a deferred certificate is built on first access */
+  byte* bytes();
+  int length();
 
-#if defined(SECURE_ELEMENT_IS_ECCX08)
-  /* Get Data to create ECCX08 compressed cert */
+  /* Get Data to create compressed cert */
   inline byte* compressedCertBytes() { return _compressedCert.data; }
   inline int compressedCertLenght() {return ECP256_CERT_COMPRESSED_CERT_LENGTH; }
   inline byte* compressedCertSignatureAndDatesBytes() { return _compressedCert.slot.one.data; }
   inline int compressedCertSignatureAndDatesLength() {return ECP256_CERT_COMPRESSED_CERT_SLOT_LENGTH; }
   inline byte* compressedCertSerialAndAuthorityKeyIdBytes() { return _compressedCert.slot.two.data; }
   inline int compressedCertSerialAndAuthorityKeyIdLenght() {return ECP256_CERT_SERIAL_NUMBER_LENGTH + ECP256_CERT_AUTHORITY_KEY_ID_LENGTH; }
-#endif
 
-  inline byte* subjectCommonNameBytes() { return (byte*)_subjectData.commonName.begin(); }
-  inline int subjectCommonNameLenght() {return _subjectData.commonName.length(); }
+  /* Backend independent storage format of the compressed cert:
+   * version byte, compressed cert, subject common name length and value,
+   * zero padded to ECP256_CERT_COMPRESSED_STORAGE_LENGTH.
+   */
+  int exportCompressedCert(byte out[], int outLen);
+  int importCompressedCert(const byte in[], int inLen);
+
+  inline byte* subjectCommonNameBytes() { return (byte*)_subjectData.value[static_cast<int>(Name::CommonName)]; }
+  inline int subjectCommonNameLenght() {return _subjectData.length[static_cast<int>(Name::CommonName)]; }
 
   inline const byte* authorityKeyIdentifierBytes() { return _compressedCert.slot.two.values.authorityKeyId; }
   inline const byte* signatureBytes() { return _compressedCert.slot.one.values.signature; }
@@ -95,11 +129,21 @@ public:
   int buildCert();
   int signCert(const byte signature[]);
   int signCert();
+  /* Build and sign with the stored signature on first bytes()/length()/getCertPEM() */
+  int deferBuildCert(const byte issuerTemplate[] = nullptr, int issuerTemplateLen = 0);
+  /* Fast path for fixed profiles: pre-encoded issuer SEQUENCE, subject common
+   * name only, authority key id set and issue year up to 2049. Fields are
+   * copied into constant DER fragments in one pass; returns 0 if the
+   * certificate does not fit, buildCert()/signCert() must be used then.
+   */
+  int buildCertFromTemplate(const byte issuerTemplate[], int issuerTemplateLen);
   String getCertPEM();
 
   /* TODO check if only for SE050*/
   /* Import DER buffer into CertClass*/
   int importCert(const byte certDER[], size_t derLen);
+  /* Import PEM text, decoded in place: pem content is overwritten */
+  int importCertPEM(char pem[], size_t pemLen);
 
 protected:
 
@@ -108,13 +152,15 @@ protected:
 
 private:
 
+  /* Each name points to caller constant data, into buffer or to a heap
+   * copy, flagged by its bit in heap
+   */
   struct CertInfo {
-    String countryName;
-    String stateProvinceName;
-    String localityName;
-    String organizationName;
-    String organizationalUnitName;
-    String commonName;
+    const char * value[ECP256_CERT_NAME_COUNT];
+    byte         length[ECP256_CERT_NAME_COUNT];
+    char         buffer[ECP256_CERT_NAME_BUFFER_LENGTH];
+    int          used;
+    byte         heap;
   }_issuerData, _subjectData;
 
   struct DateInfo {
@@ -152,9 +198,21 @@ private:
 
   byte * _certBuffer;
   int    _certBufferLen;
+  bool   _certDeferred;
+  const byte * _issuerTemplate;
+  int    _issuerTemplateLen;
+
+  /* PEM encoding of _certBuffer, valid until the buffer changes */
+  String _pem;
+  byte   _pemKind;
 
   /* only raw EC X Y values 64 byte */
-  const byte * _publicKey;
+  byte   _publicKey[ECP256_CERT_PUBLIC_KEY_LENGTH];
+  bool   _publicKeySet;
+
+  int allocCertBuffer(int length);
+  void materializeCert();
+  String cachedPEM(byte kind, const char* prefix, const char* suffix);
 
   int versionLength();
   int issuerOrSubjectLength(const CertInfo& issuerOrSubjectData);
@@ -173,7 +231,10 @@ private:
 
   int appendSequenceHeader(int length, byte out[]);
   int appendVersion(int version, byte out[]);
-  int appendName(const String& name, int type, byte out[]);
+  int setName(CertInfo& info, Name name, const char* value, int length, bool copy);
+  void releaseName(CertInfo& info, int index);
+
+  int appendName(const char* name, int nameLength, int type, byte out[]);
   int appendIssuerOrSubject(const CertInfo& issuerOrSubjectData, byte out[]);
   int appendSignature(const byte signature[], byte out[]);
   int appendSerialNumber(const byte serialNumber[], int length, byte out[]);
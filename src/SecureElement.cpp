@@ -14,6 +14,8 @@
 
 #include <SecureElementConfig.h>
 #include <SecureElement.h>
+#include <utility/SElementVerifyCache.h>
+#include <utility/SElementP256.h>
 
 /**************************************************************************************
  * CTOR/DTOR
@@ -28,8 +30,12 @@ SecureElement::SecureElement()
 #else
 
 #endif
+, _verifyCache {nullptr}
+, _verifyPolicy {VerifyPolicy::Chip}
+, _softwareVerifier {nullptr}
+, _keyCacheDepth {0}
 {
-
+  clearKeyCache();
 }
 
 /******************************************************************************
@@ -60,10 +66,62 @@ int SecureElement::SHA256(const uint8_t *buffer, size_t size, uint8_t *digest)
 #endif
 }
 
+int SecureElement::ecdsaVerify(const byte message[], const byte signature[], const byte pubkey[])
+{
+  if (_verifyCache == nullptr) {
+    return routeVerify(message, signature, pubkey);
+  }
+
+  byte key[SE_SHA256_DIGEST_LENGTH];
+  SElementVerifyCache::computeKey(message, signature, pubkey, key);
+
+  if (_verifyCache->lookup(key)) {
+    return 1;
+  }
+
+  if (!routeVerify(message, signature, pubkey)) {
+    return 0;
+  }
+
+  _verifyCache->insert(key);
+  return 1;
+}
+
+int SecureElement::serialNumber(byte sn[])
+{
+  if (keyCacheActive()) {
+    return serialNumber(sn, SE_SN_LENGTH);
+  }
+  return _secureElement.serialNumber(sn);
+}
+
+String SecureElement::serialNumber()
+{
+  if (!keyCacheActive()) {
+    return _secureElement.serialNumber();
+  }
+
+  /* Kept in the driver format, which differs between backends */
+  if (_cachedSerialNumberString.length() == 0) {
+    _cachedSerialNumberString = _secureElement.serialNumber();
+  }
+  return _cachedSerialNumberString;
+}
+
 int SecureElement::serialNumber(byte sn[], size_t length)
 {
+  if (keyCacheActive() && _cachedSerialNumberValid) {
+    if (sn == nullptr || length < SE_SN_LENGTH) {
+      return 0;
+    }
+    memcpy(sn, _cachedSerialNumber, SE_SN_LENGTH);
+    return 1;
+  }
+
 #if defined(SECURE_ELEMENT_IS_SE050)
-  return _secureElement.serialNumber(sn, length);
+  if (!_secureElement.serialNumber(sn, length)) {
+    return 0;
+  }
 #else
   if (sn == nullptr || length < SE_SN_LENGTH) {
     return 0;
@@ -73,7 +131,129 @@ int SecureElement::serialNumber(byte sn[], size_t length)
     return 0;
   }
   memcpy(sn, tmp, SE_SN_LENGTH);
-  return 1;
 #endif
+
+  if (keyCacheActive() && length >= SE_SN_LENGTH) {
+    memcpy(_cachedSerialNumber, sn, SE_SN_LENGTH);
+    _cachedSerialNumberValid = true;
+  }
+  return 1;
 }
 
+int SecureElement::generatePrivateKey(int slot, byte publicKey[])
+{
+  if (!_secureElement.generatePrivateKey(slot, publicKey)) {
+    /* The slot content is unknown after a failed generation */
+    dropCachedKey(slot);
+    return 0;
+  }
+
+  if (keyCacheActive()) {
+    storeCachedKey(slot, publicKey);
+  }
+  return 1;
+}
+
+int SecureElement::generatePublicKey(int slot, byte publicKey[])
+{
+  if (keyCacheActive()) {
+    for (int i = 0; i < SE_KEY_CACHE_PUBLIC_KEYS; i++) {
+      if (_cachedKeys[i].valid && _cachedKeys[i].slot == slot) {
+        memcpy(publicKey, _cachedKeys[i].key, sizeof(_cachedKeys[i].key));
+        return 1;
+      }
+    }
+  }
+
+  if (!_secureElement.generatePublicKey(slot, publicKey)) {
+    return 0;
+  }
+
+  if (keyCacheActive()) {
+    storeCachedKey(slot, publicKey);
+  }
+  return 1;
+}
+
+int SecureElement::writeSlot(int slot, const byte data[], int length)
+{
+  /* On SE050 key and data objects share the id space */
+  dropCachedKey(slot);
+  return _secureElement.writeSlot(slot, data, length);
+}
+
+int SecureElement::writeConfiguration(const byte config[])
+{
+  for (int i = 0; i < SE_KEY_CACHE_PUBLIC_KEYS; i++) {
+    _cachedKeys[i].valid = false;
+  }
+  return _secureElement.writeConfiguration(config);
+}
+
+void SecureElement::beginKeyCache()
+{
+  _keyCacheDepth++;
+}
+
+void SecureElement::endKeyCache()
+{
+  if (_keyCacheDepth > 0 && --_keyCacheDepth == 0) {
+    clearKeyCache();
+  }
+}
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SecureElement::routeVerify(const byte message[], const byte signature[], const byte pubkey[])
+{
+  if (_softwareVerifier != nullptr &&
+      (_verifyPolicy == VerifyPolicy::Software ||
+       (_verifyPolicy == VerifyPolicy::TrustedKey && _softwareVerifier->isTrustedKey(pubkey)))) {
+    return _softwareVerifier->verify(message, signature, pubkey);
+  }
+  return _secureElement.ecdsaVerify(message, signature, pubkey);
+}
+
+void SecureElement::clearKeyCache()
+{
+  for (int i = 0; i < SE_KEY_CACHE_PUBLIC_KEYS; i++) {
+    _cachedKeys[i].slot = -1;
+    _cachedKeys[i].valid = false;
+  }
+  _cachedNextKey = 0;
+  _cachedSerialNumberValid = false;
+  _cachedSerialNumberString = "";
+}
+
+void SecureElement::storeCachedKey(int slot, const byte publicKey[])
+{
+  int entry = -1;
+
+  for (int i = 0; i < SE_KEY_CACHE_PUBLIC_KEYS; i++) {
+    if (_cachedKeys[i].slot == slot) {
+      entry = i;
+      break;
+    }
+  }
+
+  /* New slots replace the oldest entry */
+  if (entry < 0) {
+    entry = _cachedNextKey;
+    _cachedNextKey = (_cachedNextKey + 1) % SE_KEY_CACHE_PUBLIC_KEYS;
+  }
+
+  memcpy(_cachedKeys[entry].key, publicKey, sizeof(_cachedKeys[entry].key));
+  _cachedKeys[entry].slot = slot;
+  _cachedKeys[entry].valid = true;
+}
+
+void SecureElement::dropCachedKey(int slot)
+{
+  for (int i = 0; i < SE_KEY_CACHE_PUBLIC_KEYS; i++) {
+    if (_cachedKeys[i].slot == slot) {
+      _cachedKeys[i].valid = false;
+    }
+  }
+}
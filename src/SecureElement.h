@@ -31,12 +31,20 @@
 
 #include "ECP256Certificate.h"
 
+class SElementVerifyCache;
+class SElementP256;
+
 /******************************************************************************
  * DEFINE
  ******************************************************************************/
 #define SE_SHA256_BUFFER_LENGTH  32
 #define SE_CERT_BUFFER_LENGTH  1024
 
+/* Public keys remembered while the key cache is active */
+#ifndef SE_KEY_CACHE_PUBLIC_KEYS
+  #define SE_KEY_CACHE_PUBLIC_KEYS 2
+#endif
+
 #if defined(SECURE_ELEMENT_IS_SE050)
   #define SE_SN_LENGTH SE05X_SN_LENGTH
 #elif defined(SECURE_ELEMENT_IS_ECCX08)
@@ -53,37 +61,67 @@ class SecureElement
 {
 public:
 
+  /* Where ecdsaVerify() checks signatures */
+  enum class VerifyPolicy {
+    Chip,       /* always on the secure element */
+    Software,   /* always on the MCU */
+    TrustedKey, /* the software verifier trusted key on the MCU, others on the chip */
+  };
+
   SecureElement();
 
   inline int begin() { return _secureElement.begin(); }
   inline void end() { return _secureElement.end(); }
 
-  inline int serialNumber(byte sn[]) { return _secureElement.serialNumber(sn); }
-  inline String serialNumber() { return _secureElement.serialNumber(); }
+  int serialNumber(byte sn[]);
+  String serialNumber();
   int serialNumber(byte sn[], size_t length);
 
   inline long random(long min, long max) { return this->_secureElement.random(min, max); };
   inline long random(long max) { return this->_secureElement.random(max); };
 
-  inline int generatePrivateKey(int slot, byte publicKey[]) { return _secureElement.generatePrivateKey(slot, publicKey); };
-  inline int generatePublicKey(int slot, byte publicKey[]) { return _secureElement.generatePublicKey(slot, publicKey); };
+  int generatePrivateKey(int slot, byte publicKey[]);
+  int generatePublicKey(int slot, byte publicKey[]);
 
-  inline int ecdsaVerify(const byte message[], const byte signature[], const byte pubkey[]) { return _secureElement.ecdsaVerify(message, signature, pubkey); };
+  int ecdsaVerify(const byte message[], const byte signature[], const byte pubkey[]);
   inline int ecSign(int slot, const byte message[], byte signature[]) { return _secureElement.ecSign(slot, message, signature); };
 
   int SHA256(const uint8_t *buffer, size_t size, uint8_t *digest);
 
   inline int readSlot(int slot, byte data[], int length) { return _secureElement.readSlot(slot, data, length); };
-  inline int writeSlot(int slot, const byte data[], int length) { return _secureElement.writeSlot(slot, data, length); };
+  int writeSlot(int slot, const byte data[], int length);
 
   inline int locked() { return _secureElement.locked(); }
   inline int lock() { return _secureElement.lock(); }
 #if defined(SECURE_ELEMENT_IS_ECCX08)
-  inline int writeConfiguration(const byte config[] = ECCX08_DEFAULT_TLS_CONFIG) { return _secureElement.writeConfiguration(config); }
+  int writeConfiguration(const byte config[] = ECCX08_DEFAULT_TLS_CONFIG);
 #else
-  inline int writeConfiguration(const byte config[] = nullptr) { return _secureElement.writeConfiguration(config); }
+  int writeConfiguration(const byte config[] = nullptr);
 #endif
 
+  /* Optional cache of successful ecdsaVerify() results, nullptr disables it */
+  inline void setVerifyCache(SElementVerifyCache * cache) { _verifyCache = cache; }
+  inline SElementVerifyCache * verifyCache() { return _verifyCache; }
+
+  /* Software and TrustedKey need a verifier, without one the chip is used */
+  inline void setVerifyPolicy(VerifyPolicy policy, SElementP256 * verifier = nullptr) { _verifyPolicy = policy; _softwareVerifier = verifier; }
+  inline VerifyPolicy verifyPolicy() const { return _verifyPolicy; }
+
+  /* Key and serial number cache. While active, the serial number and the
+   * public keys of the last used slots are read from the chip only once.
+   * generatePrivateKey() updates the key of its slot, writeSlot() drops it
+   * and writeConfiguration() drops all keys. The chip still wakes and idles
+   * for every command: the drivers offer no control over it. Calls nest,
+   * the cache is cleared when the outermost one ends.
+   *
+   * Library functions do not enable it themselves. It helps sketches
+   * chaining calls on the same slot, such as a certificate read() followed
+   * by rebuild() or SElementJWS::publicKey().
+   */
+  void beginKeyCache();
+  void endKeyCache();
+  inline bool keyCacheActive() const { return _keyCacheDepth > 0; }
+
 private:
 #if defined(SECURE_ELEMENT_IS_SE050)
   SE05XClass & _secureElement;
@@ -95,6 +133,40 @@ private:
 
 #endif
 
+  SElementVerifyCache * _verifyCache;
+  VerifyPolicy _verifyPolicy;
+  SElementP256 * _softwareVerifier;
+
+  int _keyCacheDepth;
+  struct {
+    byte key[64];
+    int  slot;
+    bool valid;
+  } _cachedKeys[SE_KEY_CACHE_PUBLIC_KEYS];
+  int  _cachedNextKey;
+  byte _cachedSerialNumber[SE_SN_LENGTH];
+  bool _cachedSerialNumberValid;
+  String _cachedSerialNumberString;
+
+  int routeVerify(const byte message[], const byte signature[], const byte pubkey[]);
+  void clearKeyCache();
+  void storeCachedKey(int slot, const byte publicKey[]);
+  void dropCachedKey(int slot);
+
+};
+
+/* Activates the key cache for the lifetime of the object */
+class SElementKeyCacheScope
+{
+public:
+
+  SElementKeyCacheScope(SecureElement & se) : _se(se) { _se.beginKeyCache(); }
+  ~SElementKeyCacheScope() { _se.endKeyCache(); }
+
+private:
+
+  SecureElement & _se;
+
 };
 
 #endif /* SECURE_ELEMENT_H_ */
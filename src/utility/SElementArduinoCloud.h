@@ -22,6 +22,9 @@
 #define SECURE_ELEMENT_SLOT_OFFSET                0
 #endif
 
+/* Device id is an UUID string, e.g. xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx */
+#define SEACC_DEVICE_ID_LENGTH                    36
+
 /******************************************************************************
    TYPEDEF
  ******************************************************************************/
@@ -13,25 +13,100 @@
  ******************************************************************************/
 
 #include <utility/SElementArduinoCloudCertificate.h>
+#include <utility/SElementArduinoCloudDeviceId.h>
+#include <utility/SElementParser.h>
 
 /******************************************************************************
  * LOCAL MODULE FUNCTIONS
  ******************************************************************************/
 
-static void hexStringToBytes(String in, byte out[], int length) {
-  int inLength = in.length();
-  in.toUpperCase();
-  int outLength = 0;
+/* Reads the DER tag and length at offset, returns the header length or 0 if
+ * the element does not fit in length bytes.
+ */
+static int derHeader(const byte der[], int length, int offset, byte & tag, int & contentLength)
+{
+  if (offset + 2 > length) {
+    return 0;
+  }
 
-  for (int i = 0; i < inLength && outLength < length; i += 2) {
-    char highChar = in[i];
-    char lowChar = in[i + 1];
+  tag = der[offset];
+  int headerLength = 2;
+  contentLength = der[offset + 1];
+
+  if (contentLength == 0x81 || contentLength == 0x82) {
+    int bytes = contentLength & 0x7F;
+    if (offset + 2 + bytes > length) {
+      return 0;
+    }
+    contentLength = 0;
+    for (int i = 0; i < bytes; i++) {
+      contentLength = (contentLength << 8) | der[offset + 2 + i];
+    }
+    headerLength += bytes;
+  } else if (contentLength & 0x80) {
+    return 0;
+  }
+
+  if (offset + headerLength + contentLength > length) {
+    return 0;
+  }
+  return headerLength;
+}
+
+/* Uncompressed P-256 key of the SubjectPublicKeyInfo in a certificate DER */
+static const byte * derSubjectPublicKey(const byte der[], int length)
+{
+  static const byte ecP256Algorithm[] = {
+    0x30, 0x13,
+    0x06, 0x07, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x02, 0x01,
+    0x06, 0x08, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x03, 0x01, 0x07
+  };
+  byte tag;
+  int contentLength;
+  int headerLength;
+  int offset = 0;
+
+  /* Certificate and TBSCertificate SEQUENCEs */
+  for (int i = 0; i < 2; i++) {
+    headerLength = derHeader(der, length, offset, tag, contentLength);
+    if (!headerLength || tag != 0x30) {
+      return nullptr;
+    }
+    offset += headerLength;
+  }
+
+  /* Optional [0] version, then serialNumber, signature, issuer, validity
+   * and subject
+   */
+  headerLength = derHeader(der, length, offset, tag, contentLength);
+  if (headerLength && tag == 0xA0) {
+    offset += headerLength + contentLength;
+  }
+  for (int i = 0; i < 5; i++) {
+    headerLength = derHeader(der, length, offset, tag, contentLength);
+    if (!headerLength) {
+      return nullptr;
+    }
+    offset += headerLength + contentLength;
+  }
+
+  /* SubjectPublicKeyInfo: id-ecPublicKey on prime256v1 and the BIT STRING */
+  headerLength = derHeader(der, length, offset, tag, contentLength);
+  if (!headerLength || tag != 0x30 || contentLength != (int)sizeof(ecP256Algorithm) + 4 + ECP256_CERT_PUBLIC_KEY_LENGTH) {
+    return nullptr;
+  }
+  offset += headerLength;
 
-    byte highByte = (highChar <= '9') ? (highChar - '0') : (highChar + 10 - 'A');
-    byte lowByte = (lowChar <= '9') ? (lowChar - '0') : (lowChar + 10 - 'A');
+  if (memcmp(&der[offset], ecP256Algorithm, sizeof(ecP256Algorithm)) != 0) {
+    return nullptr;
+  }
+  offset += sizeof(ecP256Algorithm);
 
-    out[outLength++] = (highByte << 4) | (lowByte & 0xF);
+  static const byte bitString[] = {0x03, 0x42, 0x00, 0x04};
+  if (memcmp(&der[offset], bitString, sizeof(bitString)) != 0) {
+    return nullptr;
   }
+  return &der[offset + sizeof(bitString)];
 }
 
 /******************************************************************************
@@ -43,26 +118,50 @@ const char constexpr SElementArduinoCloudCertificate::SEACC_ISSUER_ORGANIZATION_
 const char constexpr SElementArduinoCloudCertificate::SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME[];
 const char constexpr SElementArduinoCloudCertificate::SEACC_ISSUER_COMMON_NAME[];
 
+const byte constexpr SElementArduinoCloudCertificate::SEACC_ISSUER_TEMPLATE[];
+
 /******************************************************************************
  * PUBLIC MEMBER FUNCTIONS
  ******************************************************************************/
 
 int SElementArduinoCloudCertificate::write(SecureElement & se, ECP256Certificate & cert, const SElementArduinoCloudSlot certSlot)
+{
+  return write(&se, nullptr, cert, certSlot);
+}
+
+int SElementArduinoCloudCertificate::write(SElementSlotWriter & writer, ECP256Certificate & cert, const SElementArduinoCloudSlot certSlot)
+{
+  return write(nullptr, &writer, cert, certSlot);
+}
+
+int SElementArduinoCloudCertificate::write(SecureElement * se, SElementSlotWriter * writer, ECP256Certificate & cert, const SElementArduinoCloudSlot certSlot)
 {
 #if defined(SECURE_ELEMENT_IS_SE050) || defined(SECURE_ELEMENT_IS_SOFTSE)
-  if (!se.writeSlot(static_cast<int>(certSlot), cert.bytes(), cert.length())) {
+  byte compressed[ECP256_CERT_COMPRESSED_STORAGE_LENGTH];
+
+  /* Store the compressed form only if it reconstructs to the very same DER */
+  if (cert.exportCompressedCert(compressed, sizeof(compressed)) &&
+      compressedStorageMatches(cert, compressed, sizeof(compressed))) {
+    if (!store(se, writer, static_cast<int>(certSlot), compressed, sizeof(compressed))) {
+      return 0;
+    }
+    return 1;
+  }
+
+  DEBUG_VERBOSE("SEACC::%s storing full DER certificate", __FUNCTION__);
+  if (!store(se, writer, static_cast<int>(certSlot), cert.bytes(), cert.length())) {
     return 0;
   }
 #else
-  if (!se.writeSlot(static_cast<int>(certSlot), cert.compressedCertSignatureAndDatesBytes(), cert.compressedCertSignatureAndDatesLength())) {
+  if (!store(se, writer, static_cast<int>(certSlot), cert.compressedCertSignatureAndDatesBytes(), cert.compressedCertSignatureAndDatesLength())) {
     return 0;
   }
 
-  if (!se.writeSlot(static_cast<int>(certSlot) + 1, cert.compressedCertSerialAndAuthorityKeyIdBytes(), cert.compressedCertSerialAndAuthorityKeyIdLenght())) {
+  if (!store(se, writer, static_cast<int>(certSlot) + 1, cert.compressedCertSerialAndAuthorityKeyIdBytes(), cert.compressedCertSerialAndAuthorityKeyIdLenght())) {
     return 0;
   }
 
-  if (!se.writeSlot(static_cast<int>(certSlot) + 2, cert.subjectCommonNameBytes(), cert.subjectCommonNameLenght())) {
+  if (!store(se, writer, static_cast<int>(certSlot) + 2, cert.subjectCommonNameBytes(), cert.subjectCommonNameLenght())) {
     return 0;
   }
 #endif
@@ -71,20 +170,106 @@ int SElementArduinoCloudCertificate::write(SecureElement & se, ECP256Certificate
 
 int SElementArduinoCloudCertificate::read(SecureElement & se, ECP256Certificate & cert, const SElementArduinoCloudSlot certSlot, const SElementArduinoCloudSlot keySlot)
 {
+  return read(se, cert, nullptr, certSlot, keySlot);
+}
+
+int SElementArduinoCloudCertificate::read(SecureElement & se, ECP256Certificate & cert, SElementCertificateCacheStorage & cache, const SElementArduinoCloudSlot certSlot, const SElementArduinoCloudSlot keySlot)
+{
+  return read(se, cert, &cache, certSlot, keySlot);
+}
+
+int SElementArduinoCloudCertificate::clearCache(SElementCertificateCacheStorage & cache)
+{
+  const byte empty[SEACC_CACHE_HEADER_LENGTH] = {0};
+  return cache.write(0, empty, sizeof(empty));
+}
+
+int SElementArduinoCloudCertificate::read(SecureElement & se, ECP256Certificate & cert, SElementCertificateCacheStorage * cache, const SElementArduinoCloudSlot certSlot, const SElementArduinoCloudSlot keySlot)
+{
+  byte cacheKey[SE_SHA256_DIGEST_LENGTH];
+  SElementSHA256 sha;
+  const byte slots[] = {(byte)static_cast<int>(certSlot), (byte)static_cast<int>(keySlot)};
+
+  sha.begin();
+  sha.update(slots, sizeof(slots));
+
 #if defined(SECURE_ELEMENT_IS_SE050) || defined(SECURE_ELEMENT_IS_SOFTSE)
-  (void)keySlot;
   byte derBuffer[SE_CERT_BUFFER_LENGTH];
-  size_t derLen;
+  int derLen;
+
+#if defined(SECURE_ELEMENT_IS_SE050)
+  /* SE05X reads binary objects as a whole and rejects a shorter buffer, so a
+   * header read would only cost one failed command.
+   */
   if (!se.readSlot(static_cast<int>(certSlot), derBuffer, sizeof(derBuffer))) {
     return 0;
   }
+  derLen = storedLength(derBuffer);
+  if (derLen <= 0 || derLen > (int)sizeof(derBuffer)) {
+    DEBUG_ERROR("SEACC::%s invalid certificate header", __FUNCTION__);
+    return 0;
+  }
+#else
+  /* Read the header first, then exactly the length of the stored object */
+  if (se.readSlot(static_cast<int>(certSlot), derBuffer, SEACC_STORAGE_HEADER_LENGTH)) {
+    derLen = storedLength(derBuffer);
+    if (derLen <= 0 || derLen > (int)sizeof(derBuffer)) {
+      DEBUG_ERROR("SEACC::%s invalid certificate header", __FUNCTION__);
+      return 0;
+    }
+    if (!se.readSlot(static_cast<int>(certSlot), derBuffer, derLen)) {
+      return 0;
+    }
+  } else {
+    /* Partial reads not supported, fetch the whole buffer */
+    if (!se.readSlot(static_cast<int>(certSlot), derBuffer, sizeof(derBuffer))) {
+      return 0;
+    }
+    derLen = storedLength(derBuffer);
+    if (derLen <= 0 || derLen > (int)sizeof(derBuffer)) {
+      DEBUG_ERROR("SEACC::%s invalid certificate header", __FUNCTION__);
+      return 0;
+    }
+  }
+#endif
+
+  if (derBuffer[0] == ECP256_CERT_COMPRESSED_STORAGE_VERSION) {
+    byte publicKey[ECP256_CERT_PUBLIC_KEY_LENGTH];
+
+    cert.begin();
+
+    if (!cert.importCompressedCert(derBuffer, derLen)) {
+      return 0;
+    }
+
+    if (cache != nullptr) {
+      sha.update(derBuffer, derLen);
+      sha.end(cacheKey);
+      if (loadCached(*cache, cacheKey, cert)) {
+        return 1;
+      }
+    }
+
+    if (!se.generatePublicKey(static_cast<int>(keySlot), publicKey)) {
+      return 0;
+    }
+
+    if (!reconstruct(cert, publicKey)) {
+      return 0;
+    }
+
+    if (cache != nullptr) {
+      storeCached(*cache, cacheKey, cert);
+    }
+    return 1;
+  }
 
-  derLen = (derBuffer[2] << 8 | derBuffer[3]) + 4;
   if (!cert.importCert(derBuffer, derLen)) {
     return 0;
   }
 #else
-  String deviceId = "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx";
+  byte deviceIdBytes[SEACC_DEVICE_ID_LENGTH];
+  char deviceId[SEACC_DEVICE_ID_LENGTH];
   byte publicKey[ECP256_CERT_PUBLIC_KEY_LENGTH];
 
   cert.begin();
@@ -97,30 +282,39 @@ int SElementArduinoCloudCertificate::read(SecureElement & se, ECP256Certificate
     return 0;
   }
 
-  if (!se.readSlot(static_cast<int>(certSlot) + 2, (byte*)deviceId.begin(), deviceId.length())) {
+  if (!se.readSlot(static_cast<int>(certSlot) + 2, deviceIdBytes, sizeof(deviceIdBytes))) {
     return 0;
   }
 
-  if (!se.generatePublicKey(static_cast<int>(keySlot), publicKey)) {
+  /* Slot is shared with SElementArduinoCloudDeviceId, which may store it in binary */
+  if (!SElementArduinoCloudDeviceId::decode(deviceIdBytes, sizeof(deviceIdBytes), deviceId)) {
+    memcpy(deviceId, deviceIdBytes, sizeof(deviceId));
+  }
+
+  if (!cert.setSubjectName(ECP256Certificate::Name::CommonName, deviceId, sizeof(deviceId))) {
     return 0;
   }
 
-  cert.setSubjectCommonName(deviceId);
-  cert.setIssuerCountryName(SEACC_ISSUER_COUNTRY_NAME);
-  cert.setIssuerOrganizationName(SEACC_ISSUER_ORGANIZATION_NAME);
-  cert.setIssuerOrganizationalUnitName(SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME);
-  cert.setIssuerCommonName(SEACC_ISSUER_COMMON_NAME);
+  if (cache != nullptr) {
+    sha.update(cert.compressedCertSignatureAndDatesBytes(), cert.compressedCertSignatureAndDatesLength());
+    sha.update(cert.compressedCertSerialAndAuthorityKeyIdBytes(), cert.compressedCertSerialAndAuthorityKeyIdLenght());
+    sha.update((const byte*)deviceId, sizeof(deviceId));
+    sha.end(cacheKey);
+    if (loadCached(*cache, cacheKey, cert)) {
+      return 1;
+    }
+  }
 
-  if (!cert.setPublicKey(publicKey, ECP256_CERT_PUBLIC_KEY_LENGTH)) {
+  if (!se.generatePublicKey(static_cast<int>(keySlot), publicKey)) {
     return 0;
   }
 
-  if (!cert.buildCert()) {
+  if (!reconstruct(cert, publicKey)) {
     return 0;
   }
 
-  if (!cert.signCert()) {
-    return 0;
+  if (cache != nullptr) {
+    storeCached(*cache, cacheKey, cert);
   }
 #endif
   return 1;
@@ -135,7 +329,10 @@ int SElementArduinoCloudCertificate::signatureCompare(const byte * signatureA, c
     return -1;
   }
 
-  hexStringToBytes(signatureB, signatureBytes, sizeof(signatureBytes));
+  if (parser::hex(signatureB.c_str(), signatureB.length(), signatureBytes, sizeof(signatureBytes)) < 0) {
+    DEBUG_ERROR("SEACC::%s invalid signature", __FUNCTION__);
+    return -1;
+  }
 
   /* If authorityKeyId are matching there is no need to rebuild*/
   if (memcmp(signatureBytes, signatureA , sizeof(signatureBytes)) == 0) {
@@ -154,39 +351,189 @@ int SElementArduinoCloudCertificate::rebuild(
   byte serialNumberBytes[ECP256_CERT_SERIAL_NUMBER_LENGTH];
   byte authorityKeyIdentifierBytes[ECP256_CERT_AUTHORITY_KEY_ID_LENGTH];
   byte signatureBytes[ECP256_CERT_SIGNATURE_LENGTH];
+  byte publicKey[ECP256_CERT_PUBLIC_KEY_LENGTH];
+  parser::DateTime notBeforeDate;
+  parser::DateTime notAfterDate;
 
   if (!deviceId.length() || !notBefore.length() || !notAfter.length() || !serialNumber.length() || !authorityKeyIdentifier.length() || !signature.length() ) {
     DEBUG_ERROR("SEACC::%s input params error.", __FUNCTION__);
     return 0;
   }
 
-  hexStringToBytes(serialNumber, serialNumberBytes, sizeof(serialNumberBytes));
-  hexStringToBytes(authorityKeyIdentifier, authorityKeyIdentifierBytes, sizeof(authorityKeyIdentifierBytes));
-  hexStringToBytes(signature, signatureBytes, sizeof(signatureBytes));
+  if (parser::hex(serialNumber.c_str(), serialNumber.length(), serialNumberBytes, sizeof(serialNumberBytes)) < 0 ||
+      parser::hex(authorityKeyIdentifier.c_str(), authorityKeyIdentifier.length(), authorityKeyIdentifierBytes, sizeof(authorityKeyIdentifierBytes)) < 0 ||
+      parser::hex(signature.c_str(), signature.length(), signatureBytes, sizeof(signatureBytes)) < 0) {
+    DEBUG_ERROR("SEACC::%s invalid hex field", __FUNCTION__);
+    return 0;
+  }
+
+  if (!parser::rfc3339(notBefore.c_str(), notBefore.length(), notBeforeDate) ||
+      !parser::rfc3339(notAfter.c_str(), notAfter.length(), notAfterDate)) {
+    DEBUG_ERROR("SEACC::%s invalid date", __FUNCTION__);
+    return 0;
+  }
 
   if (!cert.begin()) {
     DEBUG_ERROR("SEACC::%s cert begin error", __FUNCTION__);
     return -1;
   }
 
-  cert.setSubjectCommonName(deviceId);
-  cert.setIssuerCountryName(SEACC_ISSUER_COUNTRY_NAME);
-  cert.setIssuerOrganizationName(SEACC_ISSUER_ORGANIZATION_NAME);
-  cert.setIssuerOrganizationalUnitName(SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME);
-  cert.setIssuerCommonName(SEACC_ISSUER_COMMON_NAME);
+  if (!cert.setSubjectCommonName(deviceId)) {
+    DEBUG_ERROR("SEACC::%s invalid device id", __FUNCTION__);
+    return 0;
+  }
   cert.setSignature(signatureBytes, sizeof(signatureBytes));
   cert.setAuthorityKeyId(authorityKeyIdentifierBytes, sizeof(authorityKeyIdentifierBytes));
   cert.setSerialNumber(serialNumberBytes, sizeof(serialNumberBytes));
-  cert.setIssueYear(notBefore.substring(0,4).toInt());
-  cert.setIssueMonth(notBefore.substring(5,7).toInt());
-  cert.setIssueDay(notBefore.substring(8,10).toInt());
-  cert.setIssueHour(notBefore.substring(11,13).toInt());
-  cert.setExpireYears(notAfter.substring(0,4).toInt() - notBefore.substring(0,4).toInt());
+  cert.setIssueYear(notBeforeDate.year);
+  cert.setIssueMonth(notBeforeDate.month);
+  cert.setIssueDay(notBeforeDate.day);
+  cert.setIssueHour(notBeforeDate.hour);
+  cert.setExpireYears(notAfterDate.year - notBeforeDate.year);
+
 
+  if (!se.generatePublicKey(static_cast<int>(keySlot), publicKey)) {
+    DEBUG_ERROR("SEACC::%s public key error", __FUNCTION__);
+    return -1;
+  }
 
-  if (!SElementCertificate::build(se, cert, static_cast<int>(keySlot))) {
+  if (!reconstruct(cert, publicKey) || cert.bytes() == nullptr) {
     DEBUG_ERROR("SEACC::%s cert build error", __FUNCTION__);
     return -1;
   }
   return 1;
 }
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementArduinoCloudCertificate::store(SecureElement * se, SElementSlotWriter * writer, int slot, const byte data[], int length)
+{
+  if (writer != nullptr) {
+    return writer->stage(slot, data, length);
+  }
+  return se->writeSlot(slot, data, length);
+}
+
+int SElementArduinoCloudCertificate::reconstruct(ECP256Certificate & cert, const byte publicKey[])
+{
+  /* Each name follows an 11 byte SET, SEQUENCE, OID and string header */
+  static_assert(sizeof(SEACC_ISSUER_TEMPLATE) == 2 + 4 * 11 + sizeof(SEACC_ISSUER_COUNTRY_NAME) - 1 +
+                sizeof(SEACC_ISSUER_ORGANIZATION_NAME) - 1 + sizeof(SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME) - 1 +
+                sizeof(SEACC_ISSUER_COMMON_NAME) - 1, "SEACC_ISSUER_TEMPLATE length mismatch");
+  static_assert(templateNameMatches(13, SEACC_ISSUER_COUNTRY_NAME, sizeof(SEACC_ISSUER_COUNTRY_NAME) - 1) &&
+                templateNameMatches(26, SEACC_ISSUER_ORGANIZATION_NAME, sizeof(SEACC_ISSUER_ORGANIZATION_NAME) - 1) &&
+                templateNameMatches(51, SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME, sizeof(SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME) - 1) &&
+                templateNameMatches(64, SEACC_ISSUER_COMMON_NAME, sizeof(SEACC_ISSUER_COMMON_NAME) - 1),
+                "SEACC_ISSUER_TEMPLATE does not match the SEACC_ISSUER_* names");
+
+  /* Issuer names are constants, reference them instead of copying */
+  if (!cert.setIssuerName(ECP256Certificate::Name::CountryName, SEACC_ISSUER_COUNTRY_NAME, sizeof(SEACC_ISSUER_COUNTRY_NAME) - 1, false) ||
+      !cert.setIssuerName(ECP256Certificate::Name::OrganizationName, SEACC_ISSUER_ORGANIZATION_NAME, sizeof(SEACC_ISSUER_ORGANIZATION_NAME) - 1, false) ||
+      !cert.setIssuerName(ECP256Certificate::Name::OrganizationalUnitName, SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME, sizeof(SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME) - 1, false) ||
+      !cert.setIssuerName(ECP256Certificate::Name::CommonName, SEACC_ISSUER_COMMON_NAME, sizeof(SEACC_ISSUER_COMMON_NAME) - 1, false)) {
+    return 0;
+  }
+
+  if (!cert.setPublicKey(publicKey, ECP256_CERT_PUBLIC_KEY_LENGTH)) {
+    return 0;
+  }
+
+  /* DER is built on first use, callers that only need the signature or
+   * authority key id never pay for it.
+   */
+  return cert.deferBuildCert(SEACC_ISSUER_TEMPLATE, sizeof(SEACC_ISSUER_TEMPLATE));
+}
+
+int SElementArduinoCloudCertificate::loadCached(SElementCertificateCacheStorage & cache, const byte key[], ECP256Certificate & cert)
+{
+  byte header[SEACC_CACHE_HEADER_LENGTH];
+
+  if (!cache.read(0, header, sizeof(header)) || header[0] != SEACC_CACHE_VERSION ||
+      memcmp(&header[1], key, SE_SHA256_DIGEST_LENGTH) != 0) {
+    DEBUG_VERBOSE("SEACC::%s cache miss", __FUNCTION__);
+    return 0;
+  }
+
+  int derLen = (header[SEACC_CACHE_HEADER_LENGTH - 2] << 8) | header[SEACC_CACHE_HEADER_LENGTH - 1];
+  if (derLen <= 0 || derLen > SE_CERT_BUFFER_LENGTH) {
+    return 0;
+  }
+
+  /* Length is bounded above, the buffer is taken from the heap like the
+   * certificate buffer it is copied into.
+   */
+  byte * der = (byte *)malloc(derLen);
+  if (der == nullptr) {
+    return 0;
+  }
+
+  int ret = cache.read(SEACC_CACHE_HEADER_LENGTH, der, derLen) &&
+            derLen >= SEACC_STORAGE_HEADER_LENGTH && storedLength(der) == derLen &&
+            cert.importCert(der, derLen);
+  free(der);
+  return ret;
+}
+
+int SElementArduinoCloudCertificate::storeCached(SElementCertificateCacheStorage & cache, const byte key[], ECP256Certificate & cert)
+{
+  byte header[SEACC_CACHE_HEADER_LENGTH];
+
+  if (cert.bytes() == nullptr) {
+    return 0;
+  }
+
+  header[0] = SEACC_CACHE_VERSION;
+  memcpy(&header[1], key, SE_SHA256_DIGEST_LENGTH);
+  header[SEACC_CACHE_HEADER_LENGTH - 2] = cert.length() >> 8;
+  header[SEACC_CACHE_HEADER_LENGTH - 1] = cert.length();
+
+  /* Header goes last, an interrupted update leaves a record that misses */
+  if (!clearCache(cache) ||
+      !cache.write(SEACC_CACHE_HEADER_LENGTH, cert.bytes(), cert.length()) ||
+      !cache.write(0, header, sizeof(header))) {
+    DEBUG_ERROR("SEACC::%s cache write error", __FUNCTION__);
+    return 0;
+  }
+  return 1;
+}
+
+int SElementArduinoCloudCertificate::storedLength(const byte header[])
+{
+  if (header[0] == ECP256_CERT_COMPRESSED_STORAGE_VERSION) {
+    return ECP256_CERT_COMPRESSED_STORAGE_LENGTH;
+  }
+
+  /* DER SEQUENCE with long form length */
+  if (header[0] == 0x30 && header[1] == 0x82) {
+    return ((header[2] << 8) | header[3]) + 4;
+  }
+
+  if (header[0] == 0x30 && header[1] == 0x81) {
+    return header[2] + 3;
+  }
+  return 0;
+}
+
+int SElementArduinoCloudCertificate::compressedStorageMatches(ECP256Certificate & cert, const byte compressed[], int compressedLen)
+{
+  ECP256Certificate check;
+
+  if (cert.bytes() == nullptr) {
+    return 0;
+  }
+
+  /* The public key is not part of the compressed form, take it from the DER */
+  const byte * publicKey = derSubjectPublicKey(cert.bytes(), cert.length());
+  if (publicKey == nullptr) {
+    return 0;
+  }
+
+  check.begin();
+  if (!check.importCompressedCert(compressed, compressedLen) || !reconstruct(check, publicKey)) {
+    return 0;
+  }
+
+  return (check.length() == cert.length() && memcmp(check.bytes(), cert.bytes(), cert.length()) == 0);
+}
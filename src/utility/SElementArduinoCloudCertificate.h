@@ -17,6 +17,19 @@
 
 #include <utility/SElementCertificate.h>
 #include <utility/SElementArduinoCloud.h>
+#include <utility/SElementCertificateCache.h>
+#include <utility/SElementSHA256.h>
+#include <utility/SElementSlotWriter.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+/* Bytes needed to tell the stored certificate format and length apart */
+#define SEACC_STORAGE_HEADER_LENGTH  4
+/* Cache record: version, SHA-256 of the slot contents, DER length */
+#define SEACC_CACHE_VERSION          0x01
+#define SEACC_CACHE_HEADER_LENGTH    (1 + SE_SHA256_DIGEST_LENGTH + 2)
 
  /******************************************************************************
  * CLASS DECLARATION
@@ -26,20 +39,75 @@ class SElementArduinoCloudCertificate : public SElementCertificate
 {
 public:
 
+  /* On SE050 and UNO R4 WiFi certificates matching the Arduino Cloud profile
+   * are stored in compressed form, other ones as full DER. Library versions
+   * that predate the compressed record cannot read it back.
+   */
   static int write(SecureElement & se, ECP256Certificate & cert, const SElementArduinoCloudSlot certSlot);
+  /* Stages the slot writes of write() in writer, to be written later */
+  static int write(SElementSlotWriter & writer, ECP256Certificate & cert, const SElementArduinoCloudSlot certSlot);
   static int read(SecureElement & se, ECP256Certificate & cert, const SElementArduinoCloudSlot certSlot, const SElementArduinoCloudSlot keySlot = SElementArduinoCloudSlot::Key);
+  /* Like read(), the DER rebuilt from compressed slot data is kept in cache
+   * and reused while the slot contents do not change. The cache is keyed on
+   * the certificate slots only: call clearCache() after generating a new
+   * private key in keySlot.
+   */
+  static int read(SecureElement & se, ECP256Certificate & cert, SElementCertificateCacheStorage & cache, const SElementArduinoCloudSlot certSlot, const SElementArduinoCloudSlot keySlot = SElementArduinoCloudSlot::Key);
+  static int clearCache(SElementCertificateCacheStorage & cache);
   static int signatureCompare(const byte * signatureA, const String & signatureB);
   static int rebuild(SecureElement & se, ECP256Certificate & cert, const String & deviceId,
                     const String & notBefore, const String & notAfter, const String & serialNumber,
                     const String & authorityKeyIdentifier, const String & signature,
                     const SElementArduinoCloudSlot keySlot = SElementArduinoCloudSlot::Key);
 
+  /* Internal, not part of the library API: public only so that the
+   * CertificateReconstructionBenchmark example can time it without a secure
+   * element. Use read() or rebuild() instead.
+   *
+   * Rebuilds the DER from compressed data and public key, using the Arduino
+   * Cloud DER template when the certificate fits the profile.
+   */
+  static int reconstruct(ECP256Certificate & cert, const byte publicKey[]);
+
 private:
 
+  static int write(SecureElement * se, SElementSlotWriter * writer, ECP256Certificate & cert, const SElementArduinoCloudSlot certSlot);
+  static int store(SecureElement * se, SElementSlotWriter * writer, int slot, const byte data[], int length);
+  static int read(SecureElement & se, ECP256Certificate & cert, SElementCertificateCacheStorage * cache, const SElementArduinoCloudSlot certSlot, const SElementArduinoCloudSlot keySlot);
+  static int loadCached(SElementCertificateCacheStorage & cache, const byte key[], ECP256Certificate & cert);
+  static int storeCached(SElementCertificateCacheStorage & cache, const byte key[], ECP256Certificate & cert);
+  static int storedLength(const byte header[]);
+  static int compressedStorageMatches(ECP256Certificate & cert, const byte compressed[], int compressedLen);
+
   static const char constexpr SEACC_ISSUER_COUNTRY_NAME[] = "US";
   static const char constexpr SEACC_ISSUER_ORGANIZATION_NAME[] = "Arduino LLC US";
   static const char constexpr SEACC_ISSUER_ORGANIZATIONAL_UNIT_NAME[] = "IT";
   static const char constexpr SEACC_ISSUER_COMMON_NAME[] = "Arduino";
+  static constexpr byte SEACC_ISSUER_TEMPLATE[] = {
+    0x30, 0x45,
+    /* countryName */
+    0x31, 0x0B, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02,
+    'U', 'S',
+    /* organizationName */
+    0x31, 0x17, 0x30, 0x15, 0x06, 0x03, 0x55, 0x04, 0x0A, 0x13, 0x0E,
+    'A', 'r', 'd', 'u', 'i', 'n', 'o', ' ', 'L', 'L', 'C', ' ', 'U', 'S',
+    /* organizationalUnitName */
+    0x31, 0x0B, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x0B, 0x13, 0x02,
+    'I', 'T',
+    /* commonName */
+    0x31, 0x10, 0x30, 0x0E, 0x06, 0x03, 0x55, 0x04, 0x03, 0x13, 0x07,
+    'A', 'r', 'd', 'u', 'i', 'n', 'o'
+  };
+
+  /* Compile time check of SEACC_ISSUER_TEMPLATE against the names above */
+  static constexpr bool templateBytesMatch(const byte der[], const char name[], int length)
+  {
+    return length == 0 || (der[0] == (byte)name[0] && templateBytesMatch(der + 1, name + 1, length - 1));
+  }
+  static constexpr bool templateNameMatches(int offset, const char name[], int length)
+  {
+    return SEACC_ISSUER_TEMPLATE[offset - 1] == length && templateBytesMatch(&SEACC_ISSUER_TEMPLATE[offset], name, length);
+  }
 
 };
 
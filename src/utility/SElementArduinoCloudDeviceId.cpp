@@ -13,32 +13,169 @@
  ******************************************************************************/
 
 #include <utility/SElementArduinoCloudDeviceId.h>
+#include <utility/SElementParser.h>
 
-int SElementArduinoCloudDeviceId::write(SecureElement & se, String & deviceId, const SElementArduinoCloudSlot idSlot)
+/******************************************************************************
+ * LOCAL MODULE FUNCTIONS
+ ******************************************************************************/
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+static const char HEX_DIGITS_UPPER[] = "0123456789ABCDEF";
+
+/* Hex digit count of each dash separated UUID group */
+static const byte UUID_GROUPS[] = {8, 4, 4, 4, 12};
+
+static int uuidToBytes(const char in[], byte out[]) {
+  for (unsigned int i = 0; i < sizeof(UUID_GROUPS); i++) {
+    if (i > 0 && *in++ != '-') {
+      return 0;
+    }
+    if (parser::hex(in, UUID_GROUPS[i], out, UUID_GROUPS[i] / 2) < 0) {
+      return 0;
+    }
+    in += UUID_GROUPS[i];
+    out += UUID_GROUPS[i] / 2;
+  }
+  return 1;
+}
+
+static void bytesToUuid(const byte in[], char out[], bool upperCase) {
+  const char * digits = upperCase ? HEX_DIGITS_UPPER : HEX_DIGITS;
+
+  for (unsigned int i = 0; i < sizeof(UUID_GROUPS); i++) {
+    if (i > 0) {
+      *out++ = '-';
+    }
+    for (int j = 0; j < UUID_GROUPS[i] / 2; j++) {
+      *out++ = digits[*in >> 4];
+      *out++ = digits[*in++ & 0x0F];
+    }
+  }
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementArduinoCloudDeviceId::write(SecureElement & se, String & deviceId, const SElementArduinoCloudSlot idSlot, const Format format)
 {
-  byte device_id_bytes[ECP256_CERT_COMPRESSED_CERT_SLOT_LENGTH] = {0};
+  return write(&se, nullptr, deviceId, idSlot, format);
+}
 
-  deviceId.getBytes(device_id_bytes, sizeof(device_id_bytes));
-  
-  if (!se.writeSlot(static_cast<int>(idSlot), device_id_bytes, sizeof(device_id_bytes))) {
+int SElementArduinoCloudDeviceId::write(SElementSlotWriter & writer, String & deviceId, const SElementArduinoCloudSlot idSlot, const Format format)
+{
+  return write(nullptr, &writer, deviceId, idSlot, format);
+}
+
+int SElementArduinoCloudDeviceId::write(SecureElement * se, SElementSlotWriter * writer, String & deviceId, const SElementArduinoCloudSlot idSlot, const Format format)
+{
+  if (format == Format::Binary) {
+#if defined(SECURE_ELEMENT_IS_ECCX08)
+    /* The id slot is the certificate subject name slot, see the header */
+    DEBUG_ERROR("SEACC::%s binary format not supported on ECCX08", __FUNCTION__);
     return 0;
+#else
+    byte device_id_bytes[SEACC_DEVICE_ID_BINARY_LENGTH] = {0};
+    bool lower = false;
+    bool upper = false;
+
+    device_id_bytes[0] = SEACC_DEVICE_ID_BINARY_MARKER;
+    if (deviceId.length() != SEACC_DEVICE_ID_LENGTH || !uuidToBytes(deviceId.c_str(), &device_id_bytes[1])) {
+      DEBUG_ERROR("SEACC::%s device id is not an UUID", __FUNCTION__);
+      return 0;
+    }
+
+    for (unsigned int i = 0; i < deviceId.length(); i++) {
+      lower |= (deviceId[i] >= 'a' && deviceId[i] <= 'f');
+      upper |= (deviceId[i] >= 'A' && deviceId[i] <= 'F');
+    }
+    if (lower && upper) {
+      DEBUG_ERROR("SEACC::%s mixed case device id, use the String format", __FUNCTION__);
+      return 0;
+    }
+    if (upper) {
+      device_id_bytes[SEACC_DEVICE_ID_BINARY_FLAGS] = SEACC_DEVICE_ID_FLAG_UPPER_CASE;
+    }
+#endif
+
+#if !defined(SECURE_ELEMENT_IS_ECCX08)
+    return store(se, writer, static_cast<int>(idSlot), device_id_bytes, sizeof(device_id_bytes));
+#endif
   }
-  return 1;
+
+  byte device_id_bytes[ECP256_CERT_COMPRESSED_CERT_SLOT_LENGTH] = {0};
+
+  deviceId.getBytes(device_id_bytes, sizeof(device_id_bytes));
+
+  return store(se, writer, static_cast<int>(idSlot), device_id_bytes, sizeof(device_id_bytes));
 }
 
 int SElementArduinoCloudDeviceId::read(SecureElement & se, String & deviceId, const SElementArduinoCloudSlot idSlot)
 {
   byte device_id_bytes[ECP256_CERT_COMPRESSED_CERT_SLOT_LENGTH] = {0};
+  char id[SEACC_DEVICE_ID_LENGTH + 1];
 
+#if defined(SECURE_ELEMENT_IS_SE050)
+  /* SE05X reads the whole object and refuses a shorter buffer, one read of
+   * the slot size fits both formats.
+   */
   if (!se.readSlot(static_cast<int>(idSlot), device_id_bytes, sizeof(device_id_bytes))) {
     return 0;
   }
+#else
+  bool binary = false;
+
+#if defined(SECURE_ELEMENT_IS_SOFTSE)
+  /* Read only the binary record first, ECCX08 has no binary ids */
+  binary = se.readSlot(static_cast<int>(idSlot), device_id_bytes, SEACC_DEVICE_ID_BINARY_LENGTH) &&
+           device_id_bytes[0] == SEACC_DEVICE_ID_BINARY_MARKER;
+#endif
+
+  /* String ids need their 36 characters, or the whole slot if partial reads
+   * are refused.
+   */
+  if (!binary &&
+      !se.readSlot(static_cast<int>(idSlot), device_id_bytes, SEACC_DEVICE_ID_LENGTH) &&
+      !se.readSlot(static_cast<int>(idSlot), device_id_bytes, sizeof(device_id_bytes))) {
+    return 0;
+  }
+#endif
+
+  if (!decode(device_id_bytes, sizeof(device_id_bytes), id)) {
+    return 0;
+  }
+
+  id[SEACC_DEVICE_ID_LENGTH] = '\0';
+  deviceId = String(id);
+  return 1;
+}
+
+int SElementArduinoCloudDeviceId::decode(const byte data[], size_t length, char deviceId[SEACC_DEVICE_ID_LENGTH])
+{
+  byte uuid[SEACC_DEVICE_ID_UUID_LENGTH];
+
+  if (length >= SEACC_DEVICE_ID_BINARY_LENGTH && data[0] == SEACC_DEVICE_ID_BINARY_MARKER) {
+    bytesToUuid(&data[1], deviceId, data[SEACC_DEVICE_ID_BINARY_FLAGS] & SEACC_DEVICE_ID_FLAG_UPPER_CASE);
+    return 1;
+  }
 
-  int chk;
-  if (sscanf(reinterpret_cast<char *>(device_id_bytes), "%4x%4x-%4x-%4x-%4x-%4x%4x%4x", &chk, &chk, &chk, &chk, &chk, &chk, &chk, &chk) != 8) {
+  /* String format, whatever follows the 36 characters is ignored */
+  if (length < SEACC_DEVICE_ID_LENGTH || !uuidToBytes((const char*)data, uuid)) {
     return 0;
   }
 
-  deviceId = String(reinterpret_cast<char *>(device_id_bytes));
+  memcpy(deviceId, data, SEACC_DEVICE_ID_LENGTH);
   return 1;
 }
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementArduinoCloudDeviceId::store(SecureElement * se, SElementSlotWriter * writer, int slot, const byte data[], int length)
+{
+  if (writer != nullptr) {
+    return writer->stage(slot, data, length);
+  }
+  return se->writeSlot(slot, data, length);
+}
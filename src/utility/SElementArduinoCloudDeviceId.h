@@ -16,6 +16,21 @@
  ******************************************************************************/
 
 #include <utility/SElementArduinoCloud.h>
+#include <utility/SElementSlotWriter.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+/* Binary format: marker, 16 UUID bytes, flags and zero padding to a multiple
+ * of 4. A string id never starts with the marker.
+ */
+#define SEACC_DEVICE_ID_BINARY_MARKER    0x01
+#define SEACC_DEVICE_ID_UUID_LENGTH      16
+#define SEACC_DEVICE_ID_BINARY_LENGTH    20
+#define SEACC_DEVICE_ID_BINARY_FLAGS     17
+/* Hex digits of the id were upper case */
+#define SEACC_DEVICE_ID_FLAG_UPPER_CASE  0x01
 
  /******************************************************************************
  * CLASS DECLARATION
@@ -25,9 +40,31 @@ class SElementArduinoCloudDeviceId
 {
 public:
 
-  static int write(SecureElement & se, String & deviceId, const SElementArduinoCloudSlot idSlot);
+  enum class Format
+  {
+    String,
+    Binary
+  };
+
+  /* String is the default, devices running older library versions can only
+   * read that format back. Binary is not available on ECCX08, where the id
+   * slot also holds the certificate subject name written by
+   * SElementArduinoCloudCertificate, and needs an id whose hex digits are all
+   * lower or all upper case, as the case is restored on read.
+   */
+  static int write(SecureElement & se, String & deviceId, const SElementArduinoCloudSlot idSlot, const Format format = Format::String);
+  /* Stages the slot write in writer, to be written later */
+  static int write(SElementSlotWriter & writer, String & deviceId, const SElementArduinoCloudSlot idSlot, const Format format = Format::String);
   static int read(SecureElement & se, String & deviceId, const SElementArduinoCloudSlot idSlot);
 
+  /* Device id of slot data in either format, deviceId is not NUL terminated */
+  static int decode(const byte data[], size_t length, char deviceId[SEACC_DEVICE_ID_LENGTH]);
+
+private:
+
+  static int write(SecureElement * se, SElementSlotWriter * writer, String & deviceId, const SElementArduinoCloudSlot idSlot, const Format format);
+  static int store(SecureElement * se, SElementSlotWriter * writer, int slot, const byte data[], int length);
+
 };
 
-#endif /* SECURE_ELEMENT_ARDUINO_CLOUD_DEVICE_ID_H_ */
\ No newline at end of file
+#endif /* SECURE_ELEMENT_ARDUINO_CLOUD_DEVICE_ID_H_ */
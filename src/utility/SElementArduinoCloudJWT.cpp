@@ -21,3 +21,86 @@ String getAIoTCloudJWT(SecureElement &se, String issuer, uint64_t iat, uint8_t s
   String token = jws.sign(se, slot, JWT_HEADER, jwtClaim.c_str());
   return token;
 }
+
+SElementJWTCache::SElementJWTCache(uint32_t lifetime, uint32_t refreshMargin)
+{
+  setLifetime(lifetime, refreshMargin);
+  clear();
+}
+
+void SElementJWTCache::setLifetime(uint32_t lifetime, uint32_t refreshMargin)
+{
+  _lifetime = lifetime;
+  _refreshMargin = (refreshMargin < lifetime / 2) ? refreshMargin : lifetime / 2;
+}
+
+String SElementJWTCache::get(SecureElement &se, const String& issuer, uint64_t now, uint8_t slot)
+{
+  Entry* victim = &_entries[0];
+
+  for (int i = 0; i < SE_JWT_CACHE_ENTRIES; i++) {
+    Entry& entry = _entries[i];
+    if (entry.valid && entry.slot == slot && entry.issuer == issuer) {
+      if (!expired(entry, now, 0)) {
+        return entry.token;
+      }
+      victim = &entry;
+      break;
+    }
+    if (!entry.valid || (victim->valid && entry.iat < victim->iat)) {
+      victim = &entry;
+    }
+  }
+
+  victim->issuer = issuer;
+  victim->slot = slot;
+  if (!refresh(se, *victim, now)) {
+    return "";
+  }
+  return victim->token;
+}
+
+int SElementJWTCache::poll(SecureElement &se, uint64_t now)
+{
+  int signedTokens = 0;
+
+  for (int i = 0; i < SE_JWT_CACHE_ENTRIES; i++) {
+    if (_entries[i].valid && expired(_entries[i], now, _refreshMargin)) {
+      signedTokens += refresh(se, _entries[i], now);
+    }
+  }
+  return signedTokens;
+}
+
+void SElementJWTCache::clear()
+{
+  for (int i = 0; i < SE_JWT_CACHE_ENTRIES; i++) {
+    _entries[i].issuer = "";
+    _entries[i].token = "";
+    _entries[i].iat = 0;
+    _entries[i].slot = 0;
+    _entries[i].valid = false;
+  }
+}
+
+bool SElementJWTCache::expired(const Entry& entry, uint64_t now, uint32_t margin) const
+{
+  /* A clock that went backwards, e.g. after a time sync, also invalidates the token */
+  if (now < entry.iat) {
+    return true;
+  }
+  return (now - entry.iat) + margin >= _lifetime;
+}
+
+int SElementJWTCache::refresh(SecureElement &se, Entry& entry, uint64_t now)
+{
+  entry.token = getAIoTCloudJWT(se, entry.issuer, now, entry.slot);
+  entry.iat = now;
+  entry.valid = entry.token.length() > 0;
+  return entry.valid ? 1 : 0;
+}
+
+String getAIoTCloudJWT(SElementJWTCache &cache, SecureElement &se, String issuer, uint64_t now, uint8_t slot)
+{
+  return cache.get(se, issuer, now, slot);
+}
@@ -12,6 +12,52 @@
 #define SECURE_ELEMENT_AIoTCloud_JWT_H_
 #include "SElementJWS.h"
 
+#ifndef SE_JWT_CACHE_ENTRIES
+  #define SE_JWT_CACHE_ENTRIES 2
+#endif
+
 String getAIoTCloudJWT(SecureElement &se, String issuer, uint64_t iat, uint8_t slot = 1);
 
+/* Tokens signed by getAIoTCloudJWT() kept per (issuer, slot).
+ *
+ * A cached token is returned while now - iat is below the lifetime. poll()
+ * is meant to be called when the sketch is idle: it signs a fresh token for
+ * every entry that is within refreshMargin seconds of expiring, so the next
+ * (re)connect does not have to wait for the secure element.
+ */
+class SElementJWTCache
+{
+public:
+
+  SElementJWTCache(uint32_t lifetime = 3600, uint32_t refreshMargin = 300);
+
+  /* refreshMargin is limited to lifetime / 2, a larger one would make poll()
+   * sign again tokens that were just refreshed.
+   */
+  void setLifetime(uint32_t lifetime, uint32_t refreshMargin);
+  String get(SecureElement &se, const String& issuer, uint64_t now, uint8_t slot = 1);
+  /* Returns the number of tokens signed */
+  int poll(SecureElement &se, uint64_t now);
+  void clear();
+
+private:
+
+  struct Entry {
+    String   issuer;
+    String   token;
+    uint64_t iat;
+    uint8_t  slot;
+    bool     valid;
+  } _entries[SE_JWT_CACHE_ENTRIES];
+
+  uint32_t _lifetime;
+  uint32_t _refreshMargin;
+
+  bool expired(const Entry& entry, uint64_t now, uint32_t margin) const;
+  int  refresh(SecureElement &se, Entry& entry, uint64_t now);
+
+};
+
+String getAIoTCloudJWT(SElementJWTCache &cache, SecureElement &se, String issuer, uint64_t now, uint8_t slot = 1);
+
 #endif
@@ -12,83 +12,171 @@
 
 namespace arduino { namespace b64 {
 
-String urlEncode(const byte in[], unsigned int length) {
-  static const char* CODES = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_=";
+static const char STD_CODES[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char URL_CODES[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
 
-  int b;
-  String out;
+/* Decoding table for both alphabets, 0xFF marks invalid characters */
+static const byte INVALID = 0xFF;
+static const byte DECODE_TABLE[128] = {
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,   62, 0xFF,   62, 0xFF,   63,
+    52,   53,   54,   55,   56,   57,   58,   59,   60,   61, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF,    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+    15,   16,   17,   18,   19,   20,   21,   22,   23,   24,   25, 0xFF, 0xFF, 0xFF, 0xFF,   63,
+  0xFF,   26,   27,   28,   29,   30,   31,   32,   33,   34,   35,   36,   37,   38,   39,   40,
+    41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/* PEM body lines are 76 characters, that is 19 groups of 3 bytes */
+static const size_t PEM_LINE_GROUPS = 19;
+
+/* Encodes whole groups and the trailing partial group, returns chars written */
+static size_t encodeGroups(const byte in[], size_t length, char out[], const char codes[], bool padding) {
+  char* start = out;
+  size_t groups = length / 3;
+
+  for (size_t i = 0; i < groups; i++, in += 3) {
+    uint32_t v = ((uint32_t)in[0] << 16) | ((uint32_t)in[1] << 8) | in[2];
+    *out++ = codes[(v >> 18) & 0x3F];
+    *out++ = codes[(v >> 12) & 0x3F];
+    *out++ = codes[(v >> 6) & 0x3F];
+    *out++ = codes[v & 0x3F];
+  }
 
-  int reserveLength = 4 * ((length + 2) / 3);
-  out.reserve(reserveLength);
-
-  for (unsigned int i = 0; i < length; i += 3) {
-    b = (in[i] & 0xFC) >> 2;
-    out += CODES[b];
-
-    b = (in[i] & 0x03) << 4;
-    if (i + 1 < length) {
-      b |= (in[i + 1] & 0xF0) >> 4;
-      out += CODES[b];
-      b = (in[i + 1] & 0x0F) << 2;
-      if (i + 2 < length) {
-         b |= (in[i + 2] & 0xC0) >> 6;
-         out += CODES[b];
-         b = in[i + 2] & 0x3F;
-         out += CODES[b];
-      } else {
-        out += CODES[b];
+  switch (length % 3) {
+    case 1:
+      *out++ = codes[in[0] >> 2];
+      *out++ = codes[(in[0] & 0x03) << 4];
+      if (padding) {
+        *out++ = '=';
+        *out++ = '=';
       }
-    } else {
-      out += CODES[b];
+      break;
+    case 2:
+      *out++ = codes[in[0] >> 2];
+      *out++ = codes[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+      *out++ = codes[(in[1] & 0x0F) << 2];
+      if (padding) {
+        *out++ = '=';
+      }
+      break;
+  }
+
+  return out - start;
+}
+
+static size_t pemBodyLength(size_t length) {
+  size_t groups = (length + 2) / 3;
+  size_t lines = (groups + PEM_LINE_GROUPS - 1) / PEM_LINE_GROUPS;
+  return 4 * groups + (lines ? lines - 1 : 0);
+}
+
+size_t encodedLength(size_t length) {
+  return 4 * ((length + 2) / 3);
+}
+
+size_t urlEncodedLength(size_t length) {
+  return (4 * length + 2) / 3;
+}
+
+size_t pemEncodedLength(size_t length, const char* prefix, const char* suffix) {
+  return pemBodyLength(length) + (prefix ? strlen(prefix) : 0) + (suffix ? strlen(suffix) : 0);
+}
+
+size_t encode(const byte in[], size_t length, char out[], size_t outLength) {
+  size_t len = encodedLength(length);
+  if (outLength < len) {
+    return 0;
+  }
+  encodeGroups(in, length, out, STD_CODES, true);
+  if (outLength > len) {
+    out[len] = '\0';
+  }
+  return len;
+}
+
+size_t urlEncode(const byte in[], size_t length, char out[], size_t outLength) {
+  size_t len = urlEncodedLength(length);
+  if (outLength < len) {
+    return 0;
+  }
+  encodeGroups(in, length, out, URL_CODES, false);
+  if (outLength > len) {
+    out[len] = '\0';
+  }
+  return len;
+}
+
+size_t pemEncode(const byte in[], size_t length, const char* prefix, const char* suffix, char out[], size_t outLength) {
+  size_t len = pemEncodedLength(length, prefix, suffix);
+  if (outLength < len) {
+    return 0;
+  }
+
+  char* cursor = out;
+  if (prefix) {
+    size_t prefixLength = strlen(prefix);
+    memcpy(cursor, prefix, prefixLength);
+    cursor += prefixLength;
+  }
+
+  const size_t lineBytes = 3 * PEM_LINE_GROUPS;
+  for (size_t i = 0; i < length; i += lineBytes) {
+    if (i > 0) {
+      *cursor++ = '\n';
     }
+    cursor += encodeGroups(&in[i], (length - i < lineBytes) ? (length - i) : lineBytes, cursor, STD_CODES, true);
+  }
+
+  if (suffix) {
+    size_t suffixLength = strlen(suffix);
+    memcpy(cursor, suffix, suffixLength);
+    cursor += suffixLength;
+  }
+
+  if (outLength > len) {
+    out[len] = '\0';
   }
+  return len;
+}
+
+String urlEncode(const byte in[], unsigned int length) {
+  /* 48 input bytes per chunk, encoded to 64 characters plus NUL */
+  char chunk[65];
+  String out;
+
+  out.reserve(urlEncodedLength(length));
 
-  while (out.lastIndexOf('=') != -1) {
-    out.remove(out.length() - 1);
+  for (unsigned int i = 0; i < length; i += 48) {
+    unsigned int n = (length - i < 48) ? (length - i) : 48;
+    urlEncode(&in[i], n, chunk, sizeof(chunk));
+    out += chunk;
   }
 
   return out;
 }
 
 String pemEncode(const byte in[], unsigned int length, const char* prefix, const char* suffix) {
-static const char* CODES = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=";
-
-  int b;
+  /* One PEM body line per chunk, plus newline and NUL */
+  char chunk[4 * PEM_LINE_GROUPS + 2];
   String out;
 
-  int reserveLength = 4 * ((length + 2) / 3) + ((length / 3 * 4) / 76) + strlen(prefix) + strlen(suffix);
-  out.reserve(reserveLength);
+  out.reserve(pemEncodedLength(length, prefix, suffix));
 
   if (prefix) {
     out += prefix;
   }
 
-  for (unsigned int i = 0; i < length; i += 3) {
-    if (i > 0 && (i / 3 * 4) % 76 == 0) {
-      out += '\n';
-    }
-
-    b = (in[i] & 0xFC) >> 2;
-    out += CODES[b];
-
-    b = (in[i] & 0x03) << 4;
-    if (i + 1 < length) {
-      b |= (in[i + 1] & 0xF0) >> 4;
-      out += CODES[b];
-      b = (in[i + 1] & 0x0F) << 2;
-      if (i + 2 < length) {
-        b |= (in[i + 2] & 0xC0) >> 6;
-        out += CODES[b];
-        b = in[i + 2] & 0x3F;
-        out += CODES[b];
-      } else {
-        out += CODES[b];
-        out += '=';
-      }
-    } else {
-      out += CODES[b];
-      out += "==";
+  const unsigned int lineBytes = 3 * PEM_LINE_GROUPS;
+  for (unsigned int i = 0; i < length; i += lineBytes) {
+    char* cursor = chunk;
+    if (i > 0) {
+      *cursor++ = '\n';
     }
+    cursor += encodeGroups(&in[i], (length - i < lineBytes) ? (length - i) : lineBytes, cursor, STD_CODES, true);
+    *cursor = '\0';
+    out += chunk;
   }
 
   if (suffix) {
@@ -98,4 +186,144 @@ static const char* CODES = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz
   return out;
 }
 
+size_t decodedMaxLength(size_t length) {
+  return (3 * length) / 4 + 2;
+}
+
+int decode(const char in[], size_t length, byte out[], size_t outLength) {
+  Decoder decoder;
+  int len = decoder.update(in, length, out, outLength);
+  if (len < 0 || !decoder.end()) {
+    return -1;
+  }
+  return len;
+}
+
+int pemDecode(const char in[], size_t length, byte out[], size_t outLength) {
+  Decoder decoder(true);
+  int len = decoder.update(in, length, out, outLength);
+  if (len < 0 || !decoder.end()) {
+    return -1;
+  }
+  return len;
+}
+
+int urlDecode(const char in[], size_t length, byte out[], size_t outLength) {
+  uint32_t bits = 0;
+  int bitCount = 0;
+  size_t written = 0;
+
+  /* A single character in the last group cannot encode a byte */
+  if (length % 4 == 1) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < length; i++) {
+    char c = in[i];
+    byte v = ((byte)c < sizeof(DECODE_TABLE)) ? DECODE_TABLE[(byte)c] : INVALID;
+    if (v == INVALID || c == '+' || c == '/') {
+      return -1;
+    }
+
+    bits = (bits << 6) | v;
+    bitCount += 6;
+
+    if (bitCount >= 8) {
+      bitCount -= 8;
+      if (out != nullptr) {
+        if (written == outLength) {
+          return -1;
+        }
+        out[written] = (byte)(bits >> bitCount);
+      }
+      written++;
+    }
+  }
+
+  if (bits & ((1UL << bitCount) - 1)) {
+    return -1;
+  }
+  return written;
+}
+
+Decoder::Decoder(bool pem)
+: _pem(pem)
+{
+  begin();
+}
+
+void Decoder::begin() {
+  _bits = 0;
+  _bitCount = 0;
+  _lineStart = true;
+  _skipLine = false;
+  _padding = false;
+  _error = false;
+}
+
+int Decoder::update(const char in[], size_t length, byte out[], size_t outLength) {
+  size_t written = 0;
+
+  if (_error) {
+    return -1;
+  }
+
+  /* Every 4 characters read produce at most 3 bytes, so out never overtakes
+   * in when both point to the same buffer.
+   */
+  for (size_t i = 0; i < length; i++) {
+    char c = in[i];
+
+    if (c == '\n') {
+      _lineStart = true;
+      _skipLine = false;
+      continue;
+    }
+
+    if (_skipLine) {
+      continue;
+    }
+
+    if (_pem && _lineStart && c == '-') {
+      _skipLine = true;
+      continue;
+    }
+    _lineStart = false;
+
+    if (c == ' ' || c == '\r' || c == '\t') {
+      continue;
+    }
+
+    if (c == '=') {
+      _padding = true;
+      continue;
+    }
+
+    byte v = ((byte)c < sizeof(DECODE_TABLE)) ? DECODE_TABLE[(byte)c] : INVALID;
+    if (v == INVALID || _padding) {
+      _error = true;
+      return -1;
+    }
+
+    _bits = (_bits << 6) | v;
+    _bitCount += 6;
+
+    if (_bitCount >= 8) {
+      if (written == outLength) {
+        _error = true;
+        return -1;
+      }
+      _bitCount -= 8;
+      out[written++] = (byte)(_bits >> _bitCount);
+    }
+  }
+
+  return written;
+}
+
+int Decoder::end() {
+  /* 6 leftover bits means a dangling single character */
+  return (!_error && _bitCount < 6);
+}
+
 }} // arduino::b64
@@ -17,4 +17,52 @@ namespace arduino { namespace b64 {
     String urlEncode(const byte in[], unsigned int length);
     String pemEncode(const byte in[], unsigned int length, const char* prefix, const char* suffix);
 
+    /* Buffer based encoders: output lengths are exact and exclude the
+     * terminating NUL, which is written only if there is room for it.
+     * They return the number of characters written or 0 if out is too small.
+     */
+    size_t encodedLength(size_t length);
+    size_t urlEncodedLength(size_t length);
+    size_t pemEncodedLength(size_t length, const char* prefix, const char* suffix);
+
+    size_t encode(const byte in[], size_t length, char out[], size_t outLength);
+    size_t urlEncode(const byte in[], size_t length, char out[], size_t outLength);
+    size_t pemEncode(const byte in[], size_t length, const char* prefix, const char* suffix, char out[], size_t outLength);
+
+    /* Decoders accept both the standard and URL safe alphabets and skip
+     * whitespace and padding. out may be the same buffer as in, decoding in
+     * place is safe. They return the number of bytes written, or -1 on an
+     * invalid character, truncated input or if out is too small.
+     */
+    size_t decodedMaxLength(size_t length);
+    int decode(const char in[], size_t length, byte out[], size_t outLength);
+    /* Like decode(), also skips -----BEGIN/END----- armor lines */
+    int pemDecode(const char in[], size_t length, byte out[], size_t outLength);
+    /* Strict base64url for signed data: URL safe alphabet only, no padding
+     * or whitespace, and unused trailing bits must be zero, so every byte
+     * string has exactly one accepted encoding. With out == nullptr the
+     * input is only validated. Returns the decoded length or -1.
+     */
+    int urlDecode(const char in[], size_t length, byte out[], size_t outLength);
+
+    /* Incremental decoder for input received in chunks */
+    class Decoder {
+    public:
+      Decoder(bool pem = false);
+
+      void begin();
+      int update(const char in[], size_t length, byte out[], size_t outLength);
+      /* Returns 1 if the input ended on a valid boundary */
+      int end();
+
+    private:
+      uint32_t _bits;
+      int      _bitCount;
+      bool     _pem;
+      bool     _lineStart;
+      bool     _skipLine;
+      bool     _padding;
+      bool     _error;
+    };
+
 }} // arduino::b64
@@ -0,0 +1,298 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <utility/SElementCOSE.h>
+#include <utility/SElementSHA256.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+#define CBOR_MAJOR_UNSIGNED   0
+#define CBOR_MAJOR_NEGATIVE   1
+#define CBOR_MAJOR_BYTES      2
+#define CBOR_MAJOR_TEXT       3
+#define CBOR_MAJOR_ARRAY      4
+#define CBOR_MAJOR_MAP        5
+#define CBOR_MAJOR_TAG        6
+#define CBOR_MAJOR_SIMPLE     7
+
+#define CBOR_MAX_DEPTH        4
+
+/******************************************************************************
+ * LOCAL MODULE FUNCTIONS
+ ******************************************************************************/
+
+/* Tag 18, array(4), protected bstr { 1: -7 }, unprotected {} */
+static const byte COSE_SIGN1_PREFIX[] = {
+  0xD2, 0x84, 0x43, 0xA1, 0x01, 0x26, 0xA0
+};
+
+/* array(4), "Signature1", protected bstr { 1: -7 }, external_aad h'' */
+static const byte COSE_SIG_STRUCTURE_PREFIX[] = {
+  0x84, 0x6A, 'S', 'i', 'g', 'n', 'a', 't', 'u', 'r', 'e', '1',
+  0x43, 0xA1, 0x01, 0x26, 0x40
+};
+
+static const byte COSE_PROTECTED_ES256[] = {
+  0xA1, 0x01, 0x26
+};
+
+/* bstr header of the 64 byte signature */
+static const byte COSE_SIGNATURE_HEAD[] = {
+  0x58, 0x40
+};
+
+static size_t headLength(size_t value) {
+  if (value < 24) {
+    return 1;
+  } else if (value < 0x100) {
+    return 2;
+  } else if (value < 0x10000) {
+    return 3;
+  }
+  return 5;
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+size_t SElementCOSE::signedLength(size_t payloadLength)
+{
+  return sizeof(COSE_SIGN1_PREFIX) + headLength(payloadLength) + payloadLength + sizeof(COSE_SIGNATURE_HEAD) + 64;
+}
+
+size_t SElementCOSE::sign(SecureElement & se, int slot, const byte payload[], size_t payloadLength, byte out[], size_t outLength)
+{
+  size_t length = signedLength(payloadLength);
+
+  if (outLength < length) {
+    return 0;
+  }
+
+  /* The Sig_structure is shorter than the message, build it in out first */
+  size_t payloadHeadLength = headLength(payloadLength);
+  size_t sigStructureLength = sizeof(COSE_SIG_STRUCTURE_PREFIX) + payloadHeadLength + payloadLength;
+  byte* sigStructurePayload = &out[sizeof(COSE_SIG_STRUCTURE_PREFIX) + payloadHeadLength];
+
+  memcpy(out, COSE_SIG_STRUCTURE_PREFIX, sizeof(COSE_SIG_STRUCTURE_PREFIX));
+  appendHead(CBOR_MAJOR_BYTES, payloadLength, &out[sizeof(COSE_SIG_STRUCTURE_PREFIX)]);
+  memcpy(sigStructurePayload, payload, payloadLength);
+
+  byte sigStructureSha256[32];
+  byte signature[64];
+
+  if (!se.SHA256(out, sigStructureLength, sigStructureSha256)) {
+    return 0;
+  }
+
+  if (!se.ecSign(slot, sigStructureSha256, signature)) {
+    return 0;
+  }
+
+  /* Move the payload to its place in the message and write the rest around it */
+  byte* cursor = out;
+  memmove(&out[sizeof(COSE_SIGN1_PREFIX) + payloadHeadLength], sigStructurePayload, payloadLength);
+  memcpy(cursor, COSE_SIGN1_PREFIX, sizeof(COSE_SIGN1_PREFIX));
+  cursor += sizeof(COSE_SIGN1_PREFIX);
+  cursor += appendHead(CBOR_MAJOR_BYTES, payloadLength, cursor);
+  cursor += payloadLength;
+  memcpy(cursor, COSE_SIGNATURE_HEAD, sizeof(COSE_SIGNATURE_HEAD));
+  cursor += sizeof(COSE_SIGNATURE_HEAD);
+  memcpy(cursor, signature, sizeof(signature));
+
+  return length;
+}
+
+int SElementCOSE::verify(SecureElement & se, const byte publicKey[], const byte message[], size_t messageLength, const byte ** payload, size_t * payloadLength)
+{
+  size_t pos = 0;
+  byte major;
+  uint32_t value;
+
+  if (messageLength > 0 && message[0] == COSE_SIGN1_PREFIX[0]) {
+    pos++;
+  }
+
+  if (!readHead(message, messageLength, &pos, &major, &value) || major != CBOR_MAJOR_ARRAY || value != 4) {
+    return 0;
+  }
+
+  /* Only ES256 is supported, anything else in the protected header is rejected */
+  if (!readHead(message, messageLength, &pos, &major, &value) || major != CBOR_MAJOR_BYTES ||
+      value != sizeof(COSE_PROTECTED_ES256) || messageLength - pos < value ||
+      memcmp(&message[pos], COSE_PROTECTED_ES256, sizeof(COSE_PROTECTED_ES256)) != 0) {
+    return 0;
+  }
+  pos += value;
+
+  size_t unprotectedPos = pos;
+  if (!readHead(message, messageLength, &unprotectedPos, &major, &value) || major != CBOR_MAJOR_MAP ||
+      !skipItem(message, messageLength, &pos, 0)) {
+    return 0;
+  }
+
+  if (!readHead(message, messageLength, &pos, &major, &value) || major != CBOR_MAJOR_BYTES || messageLength - pos < value) {
+    return 0;
+  }
+  const byte* messagePayload = &message[pos];
+  size_t messagePayloadLength = value;
+  pos += value;
+
+  if (!readHead(message, messageLength, &pos, &major, &value) || major != CBOR_MAJOR_BYTES ||
+      value != 64 || messageLength - pos != value) {
+    return 0;
+  }
+  const byte* signature = &message[pos];
+
+  /* The message is read only, hash the Sig_structure in pieces */
+  byte sigStructureHead[5];
+  byte sigStructureSha256[32];
+  SElementSHA256 sha;
+
+  sha.begin();
+  sha.update(COSE_SIG_STRUCTURE_PREFIX, sizeof(COSE_SIG_STRUCTURE_PREFIX));
+  sha.update(sigStructureHead, appendHead(CBOR_MAJOR_BYTES, messagePayloadLength, sigStructureHead));
+  sha.update(messagePayload, messagePayloadLength);
+  sha.end(sigStructureSha256);
+
+  if (!se.ecdsaVerify(sigStructureSha256, signature, publicKey)) {
+    return 0;
+  }
+
+  if (payload != nullptr) {
+    *payload = messagePayload;
+  }
+  if (payloadLength != nullptr) {
+    *payloadLength = messagePayloadLength;
+  }
+
+  return 1;
+}
+
+int SElementCOSE::verify(SecureElement & se, int publicKeyDataSlot, const byte message[], size_t messageLength, const byte ** payload, size_t * payloadLength)
+{
+  byte publicKey[64];
+
+  if (!se.readSlot(publicKeyDataSlot, publicKey, sizeof(publicKey))) {
+    return 0;
+  }
+
+  return verify(se, publicKey, message, messageLength, payload, payloadLength);
+}
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementCOSE::appendHead(byte major, size_t value, byte out[])
+{
+  int length = headLength(value);
+
+  major <<= 5;
+  switch (length) {
+    case 1:
+      out[0] = major | value;
+      break;
+    case 2:
+      out[0] = major | 24;
+      out[1] = value;
+      break;
+    case 3:
+      out[0] = major | 25;
+      out[1] = value >> 8;
+      out[2] = value;
+      break;
+    default:
+      out[0] = major | 26;
+      out[1] = (uint32_t)value >> 24;
+      out[2] = (uint32_t)value >> 16;
+      out[3] = (uint32_t)value >> 8;
+      out[4] = value;
+      break;
+  }
+
+  return length;
+}
+
+int SElementCOSE::readHead(const byte in[], size_t length, size_t * pos, byte * major, uint32_t * value)
+{
+  if (*pos >= length) {
+    return 0;
+  }
+
+  byte initial = in[(*pos)++];
+  byte info = initial & 0x1F;
+  int extra;
+
+  *major = initial >> 5;
+
+  if (info < 24) {
+    *value = info;
+    return 1;
+  } else if (info == 24) {
+    extra = 1;
+  } else if (info == 25) {
+    extra = 2;
+  } else if (info == 26) {
+    extra = 4;
+  } else {
+    /* 64 bit lengths and indefinite length items are not supported */
+    return 0;
+  }
+
+  if (length - *pos < (size_t)extra) {
+    return 0;
+  }
+
+  *value = 0;
+  for (int i = 0; i < extra; i++) {
+    *value = (*value << 8) | in[(*pos)++];
+  }
+
+  return 1;
+}
+
+int SElementCOSE::skipItem(const byte in[], size_t length, size_t * pos, int depth)
+{
+  byte major;
+  uint32_t value;
+
+  if (depth > CBOR_MAX_DEPTH || !readHead(in, length, pos, &major, &value)) {
+    return 0;
+  }
+
+  switch (major) {
+    case CBOR_MAJOR_BYTES:
+    case CBOR_MAJOR_TEXT:
+      if (length - *pos < value) {
+        return 0;
+      }
+      *pos += value;
+      return 1;
+    case CBOR_MAJOR_ARRAY:
+    case CBOR_MAJOR_MAP:
+      for (uint32_t i = 0; i < ((major == CBOR_MAJOR_MAP) ? 2 * value : value); i++) {
+        if (!skipItem(in, length, pos, depth + 1)) {
+          return 0;
+        }
+      }
+      return 1;
+    case CBOR_MAJOR_TAG:
+      return skipItem(in, length, pos, depth + 1);
+    default:
+      return 1;
+  }
+}
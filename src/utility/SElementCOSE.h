@@ -0,0 +1,59 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_COSE_H_
+#define SECURE_ELEMENT_COSE_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino_SecureElement.h>
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+/* COSE_Sign1 messages (RFC 9052) signed with ES256.
+ *
+ * The protected header only carries the algorithm, the unprotected header
+ * is empty and there is no external AAD: a message with a 10 byte payload is
+ * 84 bytes, where the equivalent JWS is about 150 characters.
+ */
+class SElementCOSE
+{
+public:
+
+  static size_t signedLength(size_t payloadLength);
+
+  /* Tagged COSE_Sign1 of payload written to out, payload must not overlap
+   * out. Returns its length or 0 on error or if out is shorter than
+   * signedLength().
+   */
+  static size_t sign(SecureElement & se, int slot, const byte payload[], size_t payloadLength, byte out[], size_t outLength);
+
+  /* Verifies a tagged or untagged ES256 COSE_Sign1 against publicKey, or
+   * against the 64 byte raw public key written to the data slot
+   * publicKeyDataSlot. It is read with readSlot(): for the key of a key slot
+   * pass the result of generatePublicKey() instead. Any unprotected header is
+   * ignored. On success payload points into message. Returns 1 on success.
+   */
+  static int verify(SecureElement & se, const byte publicKey[], const byte message[], size_t messageLength, const byte ** payload = nullptr, size_t * payloadLength = nullptr);
+  static int verify(SecureElement & se, int publicKeyDataSlot, const byte message[], size_t messageLength, const byte ** payload = nullptr, size_t * payloadLength = nullptr);
+
+private:
+
+  static int    appendHead(byte major, size_t value, byte out[]);
+  static int    readHead(const byte in[], size_t length, size_t * pos, byte * major, uint32_t * value);
+  static int    skipItem(const byte in[], size_t length, size_t * pos, int depth);
+
+};
+
+#endif /* SECURE_ELEMENT_COSE_H_ */
@@ -13,6 +13,7 @@
  ******************************************************************************/
 
 #include <utility/SElementCSR.h>
+#include <utility/SElementSHA256.h>
 
 int SElementCSR::build(SecureElement & se, ECP256Certificate & cert, const int keySlot, bool newPrivateKey)
 {
@@ -41,7 +42,9 @@ int SElementCSR::build(SecureElement & se, ECP256Certificate & cert, const int k
 
   /* compute CSR SHA256 */
   byte sha256buf[SE_SHA256_BUFFER_LENGTH];
-  se.SHA256(cert.bytes(), cert.length(), sha256buf);
+  if (!se.SHA256(cert.bytes(), cert.length(), sha256buf)) {
+    return 0;
+  }
 
   if (!se.ecSign(keySlot, sha256buf, signature)) {
     return 0;
@@ -49,4 +52,91 @@ int SElementCSR::build(SecureElement & se, ECP256Certificate & cert, const int k
 
   /* sign CSR */
   return cert.signCSR(signature);
-}
\ No newline at end of file
+}
+
+int SElementCSR::buildBatch(SecureElement & se, SElementCSRJob jobs[], int count, unsigned long * totalTime)
+{
+  byte publicKey[ECP256_CERT_PUBLIC_KEY_LENGTH];
+  byte signature[ECP256_CERT_SIGNATURE_LENGTH];
+  byte sha256buf[SE_SHA256_BUFFER_LENGTH];
+  unsigned long batchStart = micros();
+  unsigned long start;
+  int done = 0;
+
+  /* Driver calls are blocking, so chip and MCU work cannot overlap: the
+   * batch saves chip round trips instead. The CSR info is hashed on the MCU,
+   * the chip only generates keys and signs.
+   */
+  for (int i = 0; i < count; i++) {
+    SElementCSRJob & job = jobs[i];
+    job.result = 0;
+    job.keyTime = job.buildTime = job.hashTime = job.signTime = job.encodeTime = 0;
+
+    if (job.cert == nullptr) {
+      continue;
+    }
+
+    start = micros();
+    if (job.newPrivateKey) {
+      job.result = se.generatePrivateKey(job.keySlot, publicKey);
+    } else {
+      job.result = se.generatePublicKey(job.keySlot, publicKey);
+    }
+    job.keyTime = micros() - start;
+
+    if (job.result) {
+      job.result = job.cert->setPublicKey(publicKey, ECP256_CERT_PUBLIC_KEY_LENGTH);
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    SElementCSRJob & job = jobs[i];
+
+    if (!job.result) {
+      continue;
+    }
+
+    start = micros();
+    job.result = job.cert->buildCSR();
+    job.buildTime = micros() - start;
+    if (!job.result) {
+      continue;
+    }
+
+    start = micros();
+    SElementSHA256::sha256(job.cert->bytes(), job.cert->length(), sha256buf);
+    job.hashTime = micros() - start;
+
+    start = micros();
+    job.result = se.ecSign(job.keySlot, sha256buf, signature);
+    job.signTime = micros() - start;
+    if (!job.result) {
+      continue;
+    }
+
+    start = micros();
+    job.result = job.cert->signCSR(signature);
+    job.buildTime += micros() - start;
+  }
+
+  for (int i = 0; i < count; i++) {
+    SElementCSRJob & job = jobs[i];
+
+    if (!job.result) {
+      continue;
+    }
+
+    start = micros();
+    job.result = (job.cert->getCSRPEM().length() > 0);
+    job.encodeTime = micros() - start;
+
+    if (job.result) {
+      done++;
+    }
+  }
+
+  if (totalTime) {
+    *totalTime = micros() - batchStart;
+  }
+  return done;
+}
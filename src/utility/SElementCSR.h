@@ -17,6 +17,27 @@
 
 #include <Arduino_SecureElement.h>
 
+ /******************************************************************************
+   TYPEDEF
+ ******************************************************************************/
+
+/* One CSR of a batch: cert must have its subject set, results and per phase
+ * timings in microseconds are filled by SElementCSR::buildBatch().
+ */
+struct SElementCSRJob
+{
+  ECP256Certificate * cert;
+  int keySlot;
+  bool newPrivateKey;
+
+  int result;
+  unsigned long keyTime;
+  unsigned long buildTime;
+  unsigned long hashTime;
+  unsigned long signTime;
+  unsigned long encodeTime;
+};
+
  /******************************************************************************
  * CLASS DECLARATION
  ******************************************************************************/
@@ -26,6 +47,10 @@ class SElementCSR
 public:
 
   static int build(SecureElement & se, ECP256Certificate & cert, const int keySlot, bool newPrivateKey);
+  /* Runs the jobs one after another, hashing on the MCU. Returns the number
+   * of successful jobs, each CSR PEM is cached in its cert
+   */
+  static int buildBatch(SecureElement & se, SElementCSRJob jobs[], int count, unsigned long * totalTime = nullptr);
 
 };
 
@@ -0,0 +1,42 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_CERTIFICATE_CACHE_H_
+#define SECURE_ELEMENT_CERTIFICATE_CACHE_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino.h>
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+/* Persistent storage for a single reconstructed certificate record, to be
+ * implemented by the sketch on top of a file, KVStore, EEPROM or flash page.
+ *
+ * The record is addressed by offset and is at most 35 bytes plus the DER
+ * length. Both functions return 1 on success and 0 on error; reading past
+ * the end of what was written must fail.
+ */
+class SElementCertificateCacheStorage
+{
+public:
+
+  virtual ~SElementCertificateCacheStorage() { }
+
+  virtual int read(size_t offset, byte data[], size_t length) = 0;
+  virtual int write(size_t offset, const byte data[], size_t length) = 0;
+
+};
+
+#endif /* SECURE_ELEMENT_CERTIFICATE_CACHE_H_ */
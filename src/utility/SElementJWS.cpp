@@ -15,9 +15,30 @@
 #include <utility/SElementJWS.h>
 #include <utility/SElementBase64.h>
 
+/******************************************************************************
+ * LOCAL MODULE FUNCTIONS
+ ******************************************************************************/
+
+/* ECCX08 and UNO R4 key slots are 0 - 8. SE050 key objects also live above
+ * SECURE_ELEMENT_SLOT_OFFSET, as SElementArduinoCloudSlot::Key, the driver
+ * checks them.
+ */
+static bool isKeySlot(int slot)
+{
+#if defined(SECURE_ELEMENT_IS_SE050)
+  return slot >= 0;
+#else
+  return slot >= 0 && slot <= 8;
+#endif
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
 String SElementJWS::publicKey(SecureElement & se, int slot, bool newPrivateKey)
 {
-  if (slot < 0 || slot > 8) {
+  if (!isKeySlot(slot)) {
     return "";
   }
 
@@ -43,43 +64,248 @@ String SElementJWS::publicKey(SecureElement & se, int slot, bool newPrivateKey)
 
 String SElementJWS::sign(SecureElement & se, int slot, const char* header, const char* payload)
 {
-  if (slot < 0 || slot > 8) {
+  size_t length = signedLength(strlen(header), strlen(payload));
+  char* token = (char*)malloc(length + 1);
+
+  if (token == nullptr) {
     return "";
   }
 
-  String encodedHeader = b64::urlEncode((const byte*)header, strlen(header));
-  String encodedPayload = b64::urlEncode((const byte*)payload, strlen(payload));
+  String result;
+  if (sign(se, slot, header, payload, token, length + 1)) {
+    result = token;
+  }
+  free(token);
+
+  return result;
+}
+
+size_t SElementJWS::sign(SecureElement & se, int slot, const char* header, const char* payload, char out[], size_t outLength)
+{
+  if (!isKeySlot(slot)) {
+    return 0;
+  }
 
-  String toSign;
-  toSign.reserve(encodedHeader.length() + 1 + encodedPayload.length());
+  size_t headerLength = strlen(header);
+  size_t payloadLength = strlen(payload);
+  size_t length = signedLength(headerLength, payloadLength);
 
-  toSign += encodedHeader;
-  toSign += '.';
-  toSign += encodedPayload;
+  if (outLength < length) {
+    return 0;
+  }
 
+  /* header.payload is encoded in place and hashed from the output buffer */
+  char* cursor = out;
+  cursor += b64::urlEncode((const byte*)header, headerLength, cursor, b64::urlEncodedLength(headerLength));
+  *cursor++ = '.';
+  cursor += b64::urlEncode((const byte*)payload, payloadLength, cursor, b64::urlEncodedLength(payloadLength));
 
   byte toSignSha256[32];
   byte signature[64];
 
-  se.SHA256((const uint8_t*)toSign.c_str(), toSign.length(), toSignSha256);
+  if (!se.SHA256((const uint8_t*)out, cursor - out, toSignSha256)) {
+    return 0;
+  }
 
   if (!se.ecSign(slot, toSignSha256, signature)) {
-    return "";
+    return 0;
   }
 
-  String encodedSignature = b64::urlEncode(signature, sizeof(signature));
+  *cursor++ = '.';
+  cursor += b64::urlEncode(signature, sizeof(signature), cursor, b64::urlEncodedLength(sizeof(signature)));
 
-  String result;
-  result.reserve(toSign.length() + 1 + encodedSignature.length());
+  if (outLength > length) {
+    *cursor = '\0';
+  }
+
+  return length;
+}
+
+size_t SElementJWS::sign(SecureElement & se, int slot, const char* header, Stream & payload, size_t payloadLength, Print & out)
+{
+  if (!isKeySlot(slot)) {
+    return 0;
+  }
 
-  result += toSign;
-  result += '.';
-  result += encodedSignature;
+  SElementSHA256 sha;
+  size_t written = 0;
+  size_t headerLength = strlen(header);
 
-  return result;
+  sha.begin();
+
+  /* Header is split on 3 byte boundaries so chunks encode without padding */
+  for (size_t i = 0; i < headerLength; i += SE_JWS_STREAM_WINDOW) {
+    size_t n = (headerLength - i < SE_JWS_STREAM_WINDOW) ? (headerLength - i) : SE_JWS_STREAM_WINDOW;
+    size_t len = streamEncode((const byte*)&header[i], n, sha, out);
+    if (!len) {
+      return 0;
+    }
+    written += len;
+  }
+
+  sha.update((const uint8_t*)".", 1);
+  if (out.write('.') != 1) {
+    return 0;
+  }
+  written++;
+
+  /* Leftover bytes that do not fill a 3 byte group are carried to the next read */
+  byte window[SE_JWS_STREAM_WINDOW];
+  size_t pending = 0;
+
+  size_t remaining = payloadLength;
+  while (remaining > 0) {
+    size_t space = SE_JWS_STREAM_WINDOW - pending;
+    size_t want = (remaining < space) ? remaining : space;
+    /* readBytes() waits up to the Stream timeout, a short read means the
+     * payload stopped before payloadLength: do not sign partial data.
+     */
+    size_t n = payload.readBytes(&window[pending], want);
+    if (n != want) {
+      DEBUG_ERROR("SEJWS::%s payload stream ended early", __FUNCTION__);
+      return 0;
+    }
+    pending += n;
+    remaining -= n;
+
+    size_t full = pending - (pending % 3);
+    if (full) {
+      size_t len = streamEncode(window, full, sha, out);
+      if (!len) {
+        return 0;
+      }
+      written += len;
+      memmove(window, &window[full], pending - full);
+      pending -= full;
+    }
+  }
+
+  if (pending) {
+    size_t len = streamEncode(window, pending, sha, out);
+    if (!len) {
+      return 0;
+    }
+    written += len;
+  }
+
+  byte toSignSha256[32];
+  byte signature[64];
+
+  sha.end(toSignSha256);
+
+  if (!se.ecSign(slot, toSignSha256, signature)) {
+    return 0;
+  }
+
+  char encodedSignature[87];
+  size_t len = b64::urlEncode(signature, sizeof(signature), encodedSignature, sizeof(encodedSignature));
+
+  if (out.write('.') != 1 || out.write((const uint8_t*)encodedSignature, len) != len) {
+    return 0;
+  }
+
+  return written + 1 + len;
+}
+
+size_t SElementJWS::signedLength(size_t headerLength, size_t payloadLength)
+{
+  return b64::urlEncodedLength(headerLength) + 1 + b64::urlEncodedLength(payloadLength) + 1 + b64::urlEncodedLength(64);
 }
 
 String SElementJWS::sign(SecureElement & se, int slot, const String& header, const String& payload)
 {
   return sign(se, slot, header.c_str(), payload.c_str());
 }
+
+int SElementJWS::verify(SecureElement & se, const byte publicKey[], char token[], size_t tokenLength, SElementJWSView* view)
+{
+  char* firstDot = (char*)memchr(token, '.', tokenLength);
+  if (firstDot == nullptr) {
+    return 0;
+  }
+
+  size_t headerLength = firstDot - token;
+  char* payload = firstDot + 1;
+  char* secondDot = (char*)memchr(payload, '.', tokenLength - headerLength - 1);
+  if (secondDot == nullptr) {
+    return 0;
+  }
+
+  size_t payloadLength = secondDot - payload;
+  size_t signingInputLength = secondDot - token;
+  char* encodedSignature = secondDot + 1;
+  size_t encodedSignatureLength = tokenLength - signingInputLength - 1;
+
+  /* Only canonical base64url is accepted, so a token has a single valid
+   * spelling. ES256 signatures are always 64 bytes, 86 characters.
+   */
+  byte signature[64];
+  if (b64::urlDecode(token, headerLength, nullptr, 0) < 0 ||
+      b64::urlDecode(payload, payloadLength, nullptr, 0) < 0 ||
+      encodedSignatureLength != b64::urlEncodedLength(sizeof(signature)) ||
+      b64::urlDecode(encodedSignature, encodedSignatureLength, signature, sizeof(signature)) != sizeof(signature)) {
+    return 0;
+  }
+
+  byte signingInputSha256[32];
+  if (!se.SHA256((const uint8_t*)token, signingInputLength, signingInputSha256)) {
+    return 0;
+  }
+
+  if (!se.ecdsaVerify(signingInputSha256, signature, publicKey)) {
+    return 0;
+  }
+
+  if (view == nullptr) {
+    return 1;
+  }
+
+  /* Decoded data is shorter than its encoding, there is always room for the NUL */
+  int decodedHeaderLength = b64::urlDecode(token, headerLength, (byte*)token, headerLength);
+  int decodedPayloadLength = b64::urlDecode(payload, payloadLength, (byte*)payload, payloadLength);
+  if (decodedHeaderLength < 0 || decodedPayloadLength < 0) {
+    return 0;
+  }
+  token[decodedHeaderLength] = '\0';
+  payload[decodedPayloadLength] = '\0';
+
+  view->header = token;
+  view->headerLength = decodedHeaderLength;
+  view->payload = payload;
+  view->payloadLength = decodedPayloadLength;
+
+  return 1;
+}
+
+int SElementJWS::verify(SecureElement & se, int publicKeyDataSlot, char token[], size_t tokenLength, SElementJWSView* view)
+{
+  byte publicKey[64];
+
+  if (!se.readSlot(publicKeyDataSlot, publicKey, sizeof(publicKey))) {
+    return 0;
+  }
+
+  return verify(se, publicKey, token, tokenLength, view);
+}
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+size_t SElementJWS::streamEncode(const byte in[], size_t length, SElementSHA256 & sha, Print & out)
+{
+  char chunk[(4 * SE_JWS_STREAM_WINDOW) / 3 + 1];
+
+  if (length == 0) {
+    return 0;
+  }
+
+  size_t len = b64::urlEncode(in, length, chunk, sizeof(chunk));
+
+  sha.update((const uint8_t*)chunk, len);
+  if (out.write((const uint8_t*)chunk, len) != len) {
+    return 0;
+  }
+
+  return len;
+}
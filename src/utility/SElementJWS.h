@@ -16,6 +16,33 @@
  ******************************************************************************/
 
 #include <Arduino_SecureElement.h>
+#include <utility/SElementSHA256.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+/* Payload bytes read from the Stream at a time, must be a multiple of 3 */
+#ifndef SE_JWS_STREAM_WINDOW
+  #define SE_JWS_STREAM_WINDOW 48
+#endif
+
+#if (SE_JWS_STREAM_WINDOW % 3) != 0
+  #error "SE_JWS_STREAM_WINDOW must be a multiple of 3"
+#endif
+
+ /******************************************************************************
+ * TYPEDEF
+ ******************************************************************************/
+
+/* Decoded parts of a verified token, pointing into the token buffer */
+struct SElementJWSView
+{
+  const char* header;
+  size_t      headerLength;
+  const char* payload;
+  size_t      payloadLength;
+};
 
  /******************************************************************************
  * CLASS DECLARATION
@@ -30,6 +57,35 @@ public:
   String sign(SecureElement & se, int slot, const char* header, const char* payload);
   String sign(SecureElement & se, int slot, const String& header, const String& payload);
 
+  /* Compact JWS written to out, NUL terminated if there is room.
+   * Returns its length or 0 on error or if out is shorter than signedLength().
+   */
+  size_t sign(SecureElement & se, int slot, const char* header, const char* payload, char out[], size_t outLength);
+  static size_t signedLength(size_t headerLength, size_t payloadLength);
+
+  /* Compact JWS of exactly payloadLength bytes read from a Stream, waiting
+   * for each chunk up to the Stream timeout: a payload that ends early is an
+   * error, never signed. Output is written to out while it is produced, so
+   * the signing input is hashed in software. Returns the number of
+   * characters written or 0 on error, in which case out may already hold a
+   * partial token.
+   */
+  size_t sign(SecureElement & se, int slot, const char* header, Stream & payload, size_t payloadLength, Print & out);
+
+  /* Verifies a compact ES256 JWS against publicKey, or against the 64 byte
+   * raw public key written to the data slot publicKeyDataSlot, e.g. the key
+   * of a server. It is read with readSlot(): for the key of a key slot pass
+   * the result of generatePublicKey() instead. On success header and payload
+   * are decoded in place into token, each NUL terminated, and described by
+   * view; the token is no longer a valid JWS afterwards. Returns 1 on success.
+   */
+  int verify(SecureElement & se, const byte publicKey[], char token[], size_t tokenLength, SElementJWSView* view = nullptr);
+  int verify(SecureElement & se, int publicKeyDataSlot, char token[], size_t tokenLength, SElementJWSView* view = nullptr);
+
+private:
+
+  static size_t streamEncode(const byte in[], size_t length, SElementSHA256 & sha, Print & out);
+
 };
 
 
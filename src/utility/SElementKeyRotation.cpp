@@ -0,0 +1,210 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <utility/SElementKeyRotation.h>
+#include <utility/SElementCSR.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+#define KEY_ROTATION_MARKER   0x52
+#define KEY_ROTATION_VERSION  0x01
+
+/******************************************************************************
+ * LOCAL MODULE FUNCTIONS
+ ******************************************************************************/
+
+static bool isEmptyRecord(const byte record[])
+{
+  bool zero = true;
+  bool erased = true;
+
+  for (int i = 0; i < SE_KEY_ROTATION_RECORD_LENGTH; i++) {
+    zero = zero && record[i] == 0x00;
+    erased = erased && record[i] == 0xFF;
+  }
+  return zero || erased;
+}
+
+/**************************************************************************************
+ * CTOR/DTOR
+ **************************************************************************************/
+
+SElementKeyRotation::SElementKeyRotation(int slotA, int slotB, int stateSlot)
+: _slots {slotA, slotB}
+, _stateSlot {stateSlot}
+, _active {0}
+, _state {State::Idle}
+, _csrReady {false}
+, _rotationRequested {false}
+, _begun {false}
+, _generation {0}
+{
+
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementKeyRotation::begin(SecureElement & se)
+{
+  byte record[SE_KEY_ROTATION_RECORD_LENGTH];
+
+  _active = 0;
+  _state = State::Idle;
+  _csrReady = false;
+  _rotationRequested = false;
+  _begun = false;
+  _generation = 0;
+
+  if (!se.readSlot(_stateSlot, record, sizeof(record))) {
+    DEBUG_ERROR("SEKR::%s state record read error", __FUNCTION__);
+    return 0;
+  }
+
+  if (isEmptyRecord(record)) {
+    DEBUG_VERBOSE("SEKR::%s no state record", __FUNCTION__);
+    _begun = true;
+    return 1;
+  }
+
+  if (record[0] != KEY_ROTATION_MARKER || record[1] != KEY_ROTATION_VERSION || record[2] > 1 ||
+      record[3] > static_cast<byte>(State::Committed)) {
+    DEBUG_ERROR("SEKR::%s invalid state record", __FUNCTION__);
+    return 0;
+  }
+
+  _active = record[2];
+  _state = static_cast<State>(record[3]);
+  _generation = ((uint32_t)record[4] << 24) | ((uint32_t)record[5] << 16) | ((uint32_t)record[6] << 8) | record[7];
+  _begun = true;
+  return 1;
+}
+
+int SElementKeyRotation::startRotation()
+{
+  if (!_begun) {
+    DEBUG_ERROR("SEKR::%s begin() not called", __FUNCTION__);
+    return 0;
+  }
+
+  if (_state != State::KeyReady) {
+    _rotationRequested = true;
+  }
+  return 1;
+}
+
+int SElementKeyRotation::poll(SecureElement & se, ECP256Certificate & csr)
+{
+  if (!_begun) {
+    DEBUG_ERROR("SEKR::%s begin() not called", __FUNCTION__);
+    return 0;
+  }
+
+  if (_state != State::KeyReady) {
+    if (!_rotationRequested) {
+      return 1;
+    }
+
+    /* The previous key is about to be overwritten, close the rollback window first */
+    if (_state == State::Committed) {
+      if (!writeRecord(se, _active, State::Idle, _generation)) {
+        return 0;
+      }
+      _state = State::Idle;
+      return 1;
+    }
+
+    byte publicKey[ECP256_CERT_PUBLIC_KEY_LENGTH];
+
+    if (!se.generatePrivateKey(standbySlot(), publicKey)) {
+      DEBUG_ERROR("SEKR::%s key generation error", __FUNCTION__);
+      return 0;
+    }
+
+    /* Persisted, so a reset does not throw the new key away */
+    if (!writeRecord(se, _active, State::KeyReady, _generation)) {
+      return 0;
+    }
+    _state = State::KeyReady;
+    _csrReady = false;
+    _rotationRequested = false;
+    return 1;
+  }
+
+  if (!_csrReady) {
+    if (!SElementCSR::build(se, csr, standbySlot(), false)) {
+      DEBUG_ERROR("SEKR::%s CSR error", __FUNCTION__);
+      return 0;
+    }
+    _csrReady = true;
+  }
+  return 1;
+}
+
+int SElementKeyRotation::commit(SecureElement & se)
+{
+  if (!_begun || _state != State::KeyReady) {
+    DEBUG_ERROR("SEKR::%s no standby key", __FUNCTION__);
+    return 0;
+  }
+
+  if (!writeRecord(se, _active ^ 1, State::Committed, _generation + 1)) {
+    return 0;
+  }
+
+  _active ^= 1;
+  _state = State::Committed;
+  _csrReady = false;
+  _generation++;
+  return 1;
+}
+
+int SElementKeyRotation::rollback(SecureElement & se)
+{
+  if (!_begun || _state != State::Committed || _rotationRequested) {
+    DEBUG_ERROR("SEKR::%s no previous key", __FUNCTION__);
+    return 0;
+  }
+
+  /* The standby slot is regenerated by the next rotation, not usable twice */
+  if (!writeRecord(se, _active ^ 1, State::Idle, _generation - 1)) {
+    return 0;
+  }
+
+  _active ^= 1;
+  _state = State::Idle;
+  _generation--;
+  return 1;
+}
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementKeyRotation::writeRecord(SecureElement & se, int active, State state, uint32_t generation)
+{
+  const byte record[SE_KEY_ROTATION_RECORD_LENGTH] = {
+    KEY_ROTATION_MARKER, KEY_ROTATION_VERSION, (byte)active, static_cast<byte>(state),
+    (byte)(generation >> 24), (byte)(generation >> 16), (byte)(generation >> 8), (byte)generation
+  };
+
+  if (!se.writeSlot(_stateSlot, record, sizeof(record))) {
+    DEBUG_ERROR("SEKR::%s state record write error", __FUNCTION__);
+    return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,97 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_KEY_ROTATION_H_
+#define SECURE_ELEMENT_KEY_ROTATION_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino_SecureElement.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+/* State record: marker, version, active key index, state, generation */
+#define SE_KEY_ROTATION_RECORD_LENGTH  8
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+/* A/B private key rotation between two key slots.
+ *
+ * startRotation() requests a new key. poll() is meant to be called when the
+ * sketch is idle and does at most one secure element operation per call:
+ * first it generates a new key in the standby slot, then it builds the CSR
+ * for it. The active slot keeps signing meanwhile. Once the certificate
+ * issued for the CSR is installed, commit() makes the standby slot active
+ * with a single write of the state record, so a reset leaves either the old
+ * or the new key active.
+ *
+ * After commit() the standby slot keeps the previous key until the next
+ * startRotation(), rollback() switches back to it if the new certificate
+ * turns out to be rejected. The sketch restores the matching certificate.
+ */
+class SElementKeyRotation
+{
+public:
+
+  enum class State : byte
+  {
+    Idle,
+    KeyReady,
+    Committed
+  };
+
+  SElementKeyRotation(int slotA, int slotB, int stateSlot);
+
+  /* Loads the state record. An empty slot (all 0x00 or 0xFF) makes slotA
+   * active, a read error or a malformed record returns 0: the other calls
+   * refuse to run until begin() succeeds.
+   */
+  int begin(SecureElement & se);
+
+  inline int activeSlot() const { return _slots[_active]; }
+  inline int standbySlot() const { return _slots[_active ^ 1]; }
+  inline State state() const { return _state; }
+  inline bool csrReady() const { return _csrReady; }
+  inline uint32_t generation() const { return _generation; }
+  inline bool rotationPending() const { return _rotationRequested || _state == State::KeyReady; }
+
+  /* Asks poll() to generate a new standby key, this discards the previous key */
+  int startRotation();
+  /* csr must have begin() called and its subject set. Does nothing unless a
+   * rotation was started. Returns 0 on error
+   */
+  int poll(SecureElement & se, ECP256Certificate & csr);
+  /* Switches to the standby key, to be called once its certificate is stored */
+  int commit(SecureElement & se);
+  /* Switches back to the previous key after commit(), before startRotation() */
+  int rollback(SecureElement & se);
+
+private:
+
+  int      _slots[2];
+  int      _stateSlot;
+  int      _active;
+  State    _state;
+  bool     _csrReady;
+  bool     _rotationRequested;
+  bool     _begun;
+  uint32_t _generation;
+
+  int writeRecord(SecureElement & se, int active, State state, uint32_t generation);
+
+};
+
+#endif /* SECURE_ELEMENT_KEY_ROTATION_H_ */
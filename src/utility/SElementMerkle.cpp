@@ -0,0 +1,195 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <utility/SElementMerkle.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+#define MERKLE_LEAF_PREFIX  0x00
+#define MERKLE_NODE_PREFIX  0x01
+#define MERKLE_ROOT_PREFIX  0x02
+
+/**************************************************************************************
+ * CTOR/DTOR
+ **************************************************************************************/
+
+SElementMerkleSigner::SElementMerkleSigner()
+{
+  begin();
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+void SElementMerkleSigner::begin()
+{
+  _count = 0;
+  _built = false;
+}
+
+int SElementMerkleSigner::add(const byte message[], size_t length)
+{
+  if (_count >= SE_MERKLE_MAX_LEAVES) {
+    return -1;
+  }
+
+  hashLeaf(message, length, _nodes[_count]);
+  _built = false;
+
+  return _count++;
+}
+
+int SElementMerkleSigner::sign(SecureElement & se, int slot, byte signature[], byte root[])
+{
+  if (_count == 0) {
+    return 0;
+  }
+
+  /* Levels are stored one after the other, an odd node out is copied up */
+  int level = 0;
+  int size = _count;
+  while (size > 1) {
+    int next = level + size;
+    for (int i = 0; i < size; i += 2) {
+      if (i + 1 < size) {
+        hashNode(_nodes[level + i], _nodes[level + i + 1], _nodes[next + i / 2]);
+      } else {
+        memcpy(_nodes[next + i / 2], _nodes[level + i], SE_SHA256_DIGEST_LENGTH);
+      }
+    }
+    level = next;
+    size = (size + 1) / 2;
+  }
+  _built = true;
+
+  byte rootSha256[SE_SHA256_DIGEST_LENGTH];
+  hashRoot(_nodes[level], _count, rootSha256);
+
+  if (root != nullptr) {
+    memcpy(root, _nodes[level], SE_SHA256_DIGEST_LENGTH);
+  }
+
+  return se.ecSign(slot, rootSha256, signature);
+}
+
+int SElementMerkleSigner::proof(int index, byte proof[][SE_SHA256_DIGEST_LENGTH], int maxLength) const
+{
+  if (!_built || index < 0 || index >= _count) {
+    return -1;
+  }
+
+  int length = 0;
+  int level = 0;
+  int size = _count;
+  while (size > 1) {
+    int sibling = index ^ 1;
+    if (sibling < size) {
+      if (length >= maxLength) {
+        return -1;
+      }
+      memcpy(proof[length++], _nodes[level + sibling], SE_SHA256_DIGEST_LENGTH);
+    }
+    level += size;
+    index >>= 1;
+    size = (size + 1) / 2;
+  }
+
+  return length;
+}
+
+int SElementMerkleSigner::verify(SecureElement & se, const byte publicKey[], const byte signature[],
+                                 const byte message[], size_t length, int index, int count,
+                                 const byte proof[][SE_SHA256_DIGEST_LENGTH], int proofLength)
+{
+  if (count <= 0 || index < 0 || index >= count) {
+    return 0;
+  }
+
+  byte node[SE_SHA256_DIGEST_LENGTH];
+  hashLeaf(message, length, node);
+
+  int used = 0;
+  int size = count;
+  while (size > 1) {
+    int sibling = index ^ 1;
+    if (sibling < size) {
+      if (used >= proofLength) {
+        return 0;
+      }
+      if (index & 1) {
+        hashNode(proof[used], node, node);
+      } else {
+        hashNode(node, proof[used], node);
+      }
+      used++;
+    }
+    index >>= 1;
+    size = (size + 1) / 2;
+  }
+
+  if (used != proofLength) {
+    return 0;
+  }
+
+  byte rootSha256[SE_SHA256_DIGEST_LENGTH];
+  hashRoot(node, count, rootSha256);
+
+  return se.ecdsaVerify(rootSha256, signature, publicKey);
+}
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+void SElementMerkleSigner::hashLeaf(const byte message[], size_t length, byte out[])
+{
+  const byte prefix = MERKLE_LEAF_PREFIX;
+  SElementSHA256 sha;
+
+  sha.begin();
+  sha.update(&prefix, 1);
+  sha.update(message, length);
+  sha.end(out);
+}
+
+void SElementMerkleSigner::hashNode(const byte left[], const byte right[], byte out[])
+{
+  const byte prefix = MERKLE_NODE_PREFIX;
+  SElementSHA256 sha;
+
+  /* out may alias left or right, it is only written by end() */
+  sha.begin();
+  sha.update(&prefix, 1);
+  sha.update(left, SE_SHA256_DIGEST_LENGTH);
+  sha.update(right, SE_SHA256_DIGEST_LENGTH);
+  sha.end(out);
+}
+
+void SElementMerkleSigner::hashRoot(const byte root[], int count, byte out[])
+{
+  const byte prefix[] = {
+    MERKLE_ROOT_PREFIX,
+    (byte)((uint32_t)count >> 24), (byte)((uint32_t)count >> 16),
+    (byte)((uint32_t)count >> 8), (byte)count
+  };
+  SElementSHA256 sha;
+
+  sha.begin();
+  sha.update(prefix, sizeof(prefix));
+  sha.update(root, SE_SHA256_DIGEST_LENGTH);
+  sha.end(out);
+}
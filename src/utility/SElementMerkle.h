@@ -0,0 +1,88 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_MERKLE_H_
+#define SECURE_ELEMENT_MERKLE_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino_SecureElement.h>
+#include <utility/SElementSHA256.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+/* Each leaf costs 64 bytes of RAM: its hash and its share of the tree nodes */
+#ifndef SE_MERKLE_MAX_LEAVES
+  #define SE_MERKLE_MAX_LEAVES 32
+#endif
+
+/* Enough for 65536 leaves, proof() never returns more hashes than this */
+#define SE_MERKLE_MAX_PROOF_LENGTH 16
+
+/* All levels of a tree of n leaves take at most 2n - 1 nodes, plus one per
+ * level above the leaves when odd nodes are promoted
+ */
+#define SE_MERKLE_MAX_NODES (2 * SE_MERKLE_MAX_LEAVES + SE_MERKLE_MAX_PROOF_LENGTH)
+
+static_assert(SE_MERKLE_MAX_LEAVES > 0 && SE_MERKLE_MAX_LEAVES <= (1L << SE_MERKLE_MAX_PROOF_LENGTH),
+              "SE_MERKLE_MAX_LEAVES must be between 1 and 65536");
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+/* Authenticates a batch of messages with a single secure element signature.
+ *
+ * Leaves are SHA-256(0x00 || message) and nodes SHA-256(0x01 || left || right)
+ * as in RFC 6962, with the last node of an odd level promoted unchanged. The
+ * secure element signs SHA-256(0x02 || count as 32 bit big endian || root),
+ * so each message can be verified alone with its index, the batch size, its
+ * inclusion proof and the batch signature.
+ */
+class SElementMerkleSigner
+{
+public:
+
+  SElementMerkleSigner();
+
+  void begin();
+  /* Returns the leaf index of the message or -1 if the batch is full */
+  int  add(const byte message[], size_t length);
+  inline int count() const { return _count; }
+
+  /* Builds the tree and signs its root, root may be nullptr */
+  int  sign(SecureElement & se, int slot, byte signature[], byte root[] = nullptr);
+  /* Sibling hashes of leaf index from the bottom up, valid after sign().
+   * Returns the number of hashes written or -1 on error.
+   */
+  int  proof(int index, byte proof[][SE_SHA256_DIGEST_LENGTH], int maxLength) const;
+
+  static int verify(SecureElement & se, const byte publicKey[], const byte signature[],
+                    const byte message[], size_t length, int index, int count,
+                    const byte proof[][SE_SHA256_DIGEST_LENGTH], int proofLength);
+
+private:
+
+  /* Level 0 holds the leaves, upper levels follow it once the tree is built */
+  byte _nodes[SE_MERKLE_MAX_NODES][SE_SHA256_DIGEST_LENGTH];
+  int  _count;
+  bool _built;
+
+  static void hashLeaf(const byte message[], size_t length, byte out[]);
+  static void hashNode(const byte left[], const byte right[], byte out[]);
+  static void hashRoot(const byte root[], int count, byte out[]);
+
+};
+
+#endif /* SECURE_ELEMENT_MERKLE_H_ */
@@ -0,0 +1,589 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <SecureElementConfig.h>
+#include <utility/SElementP256.h>
+
+/******************************************************************************
+ * LOCAL MODULE FUNCTIONS
+ ******************************************************************************/
+
+/* Multiprecision values are 8 limbs, least significant first */
+struct Modulus {
+  uint32_t m[8];
+  uint32_t rr[8];   /* R^2 mod m, R = 2^256 */
+  uint32_t m0inv;   /* -m^-1 mod 2^32 */
+};
+
+static const Modulus P = {
+  { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xffffffff },
+  { 0x00000003, 0x00000000, 0xffffffff, 0xfffffffb, 0xfffffffe, 0xffffffff, 0xfffffffd, 0x00000004 },
+  0x00000001
+};
+
+static const Modulus N = {
+  { 0xfc632551, 0xf3b9cac2, 0xa7179e84, 0xbce6faad, 0xffffffff, 0xffffffff, 0x00000000, 0xffffffff },
+  { 0xbe79eea2, 0x83244c95, 0x49bd6fa6, 0x4699799c, 0x2b6bec59, 0x2845b239, 0xf3d95620, 0x66e12d94 },
+  0xee00bc4f
+};
+
+static const uint32_t CURVE_B[8] = {
+  0x27d2604b, 0x3bce3c3e, 0xcc53b0f6, 0x651d06b0, 0x769886bc, 0xb3ebbd55, 0xaa3a93e7, 0x5ac635d8
+};
+
+static const byte GENERATOR[64] = {
+  0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47, 0xf8, 0xbc, 0xe6, 0xe5, 0x63, 0xa4, 0x40, 0xf2,
+  0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0, 0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96,
+  0x4f, 0xe3, 0x42, 0xe2, 0xfe, 0x1a, 0x7f, 0x9b, 0x8e, 0xe7, 0xeb, 0x4a, 0x7c, 0x0f, 0x9e, 0x16,
+  0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce, 0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5
+};
+
+static const uint32_t ONE[8] = { 1, 0, 0, 0, 0, 0, 0, 0 };
+
+/* Z = 0 is the point at infinity */
+struct JacobianPoint {
+  uint32_t x[8];
+  uint32_t y[8];
+  uint32_t z[8];
+};
+
+static void fromBytes(uint32_t r[], const byte in[])
+{
+  for (int i = 0; i < 8; i++) {
+    const byte * b = &in[28 - 4 * i];
+    r[i] = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+  }
+}
+
+static bool isZero(const uint32_t a[])
+{
+  uint32_t acc = 0;
+  for (int i = 0; i < 8; i++) {
+    acc |= a[i];
+  }
+  return acc == 0;
+}
+
+static bool isEqual(const uint32_t a[], const uint32_t b[])
+{
+  return memcmp(a, b, 8 * sizeof(uint32_t)) == 0;
+}
+
+/* -1, 0 or 1 as a is lower, equal or greater than b */
+static int compare(const uint32_t a[], const uint32_t b[])
+{
+  for (int i = 7; i >= 0; i--) {
+    if (a[i] != b[i]) {
+      return a[i] > b[i] ? 1 : -1;
+    }
+  }
+  return 0;
+}
+
+static uint32_t add(uint32_t r[], const uint32_t a[], const uint32_t b[])
+{
+  uint64_t c = 0;
+  for (int i = 0; i < 8; i++) {
+    c += (uint64_t)a[i] + b[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  return (uint32_t)c;
+}
+
+static uint32_t sub(uint32_t r[], const uint32_t a[], const uint32_t b[])
+{
+  int64_t c = 0;
+  for (int i = 0; i < 8; i++) {
+    c += (int64_t)a[i] - b[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  return (uint32_t)c & 1;
+}
+
+static void modAdd(uint32_t r[], const uint32_t a[], const uint32_t b[], const Modulus & M)
+{
+  if (add(r, a, b) || compare(r, M.m) >= 0) {
+    sub(r, r, M.m);
+  }
+}
+
+static void modSub(uint32_t r[], const uint32_t a[], const uint32_t b[], const Modulus & M)
+{
+  if (sub(r, a, b)) {
+    add(r, r, M.m);
+  }
+}
+
+/* r = a * b / R mod m, inputs lower than m. The 32 x 32 -> 64 bit products
+ * map to single multiply-accumulate instructions on Cortex-M3 and up.
+ */
+static void montMul(uint32_t r[], const uint32_t a[], const uint32_t b[], const Modulus & M)
+{
+  uint32_t t[10] = { 0 };
+
+  for (int i = 0; i < 8; i++) {
+    uint64_t c = 0;
+    for (int j = 0; j < 8; j++) {
+      c = (uint64_t)a[j] * b[i] + t[j] + (c >> 32);
+      t[j] = (uint32_t)c;
+    }
+    c = (uint64_t)t[8] + (c >> 32);
+    t[8] = (uint32_t)c;
+    t[9] = (uint32_t)(c >> 32);
+
+    uint32_t q = t[0] * M.m0inv;
+    c = (uint64_t)q * M.m[0] + t[0];
+    for (int j = 1; j < 8; j++) {
+      c = (uint64_t)q * M.m[j] + t[j] + (c >> 32);
+      t[j - 1] = (uint32_t)c;
+    }
+    c = (uint64_t)t[8] + (c >> 32);
+    t[7] = (uint32_t)c;
+    t[8] = t[9] + (uint32_t)(c >> 32);
+  }
+
+  if (t[8] || compare(t, M.m) >= 0) {
+    sub(t, t, M.m);
+  }
+  memcpy(r, t, 8 * sizeof(uint32_t));
+}
+
+/* a^-1 in Montgomery form from a in Montgomery form, as a^(m - 2) */
+static void montInv(uint32_t r[], const uint32_t a[], const Modulus & M)
+{
+  uint32_t e[8];
+  uint32_t x[8];
+
+  memcpy(e, M.m, sizeof(e));
+  e[0] -= 2;
+
+  montMul(x, ONE, M.rr, M);
+  for (int i = 255; i >= 0; i--) {
+    montMul(x, x, x, M);
+    if ((e[i / 32] >> (i % 32)) & 1) {
+      montMul(x, x, a, M);
+    }
+  }
+  memcpy(r, x, sizeof(x));
+}
+
+static inline void fpMul(uint32_t r[], const uint32_t a[], const uint32_t b[]) { montMul(r, a, b, P); }
+static inline void fpSqr(uint32_t r[], const uint32_t a[]) { montMul(r, a, a, P); }
+static inline void fpAdd(uint32_t r[], const uint32_t a[], const uint32_t b[]) { modAdd(r, a, b, P); }
+static inline void fpSub(uint32_t r[], const uint32_t a[], const uint32_t b[]) { modSub(r, a, b, P); }
+
+static void setInfinity(JacobianPoint & R)
+{
+  memset(&R, 0, sizeof(R));
+}
+
+/* dbl-2001-b, a = -3 */
+static void pointDouble(JacobianPoint & R, const JacobianPoint & A)
+{
+  uint32_t delta[8], gamma[8], beta[8], alpha[8], t[8], u[8];
+
+  if (isZero(A.z)) {
+    setInfinity(R);
+    return;
+  }
+
+  fpSqr(delta, A.z);
+  fpSqr(gamma, A.y);
+  fpMul(beta, A.x, gamma);
+
+  fpSub(t, A.x, delta);
+  fpAdd(u, A.x, delta);
+  fpMul(t, t, u);
+  fpAdd(alpha, t, t);
+  fpAdd(alpha, alpha, t);
+
+  /* Z3 = (Y + Z)^2 - gamma - delta */
+  fpAdd(t, A.y, A.z);
+  fpSqr(t, t);
+  fpSub(t, t, gamma);
+  fpSub(R.z, t, delta);
+
+  /* X3 = alpha^2 - 8 beta */
+  fpAdd(beta, beta, beta);
+  fpAdd(beta, beta, beta);
+  fpAdd(u, beta, beta);
+  fpSqr(t, alpha);
+  fpSub(R.x, t, u);
+
+  /* Y3 = alpha (4 beta - X3) - 8 gamma^2 */
+  fpSub(t, beta, R.x);
+  fpMul(t, alpha, t);
+  fpSqr(gamma, gamma);
+  fpAdd(gamma, gamma, gamma);
+  fpAdd(gamma, gamma, gamma);
+  fpAdd(gamma, gamma, gamma);
+  fpSub(R.y, t, gamma);
+}
+
+/* madd-2007-bl, B affine. R may be A */
+static void pointAddAffine(JacobianPoint & R, const JacobianPoint & A, const uint32_t bx[], const uint32_t by[])
+{
+  uint32_t z1z1[8], u2[8], s2[8], h[8], hh[8], i[8], j[8], r[8], v[8], t[8];
+
+  if (isZero(A.z)) {
+    memcpy(R.x, bx, sizeof(R.x));
+    memcpy(R.y, by, sizeof(R.y));
+    montMul(R.z, ONE, P.rr, P);
+    return;
+  }
+
+  fpSqr(z1z1, A.z);
+  fpMul(u2, bx, z1z1);
+  fpMul(s2, by, A.z);
+  fpMul(s2, s2, z1z1);
+  fpSub(h, u2, A.x);
+  fpSub(r, s2, A.y);
+
+  if (isZero(h)) {
+    if (isZero(r)) {
+      pointDouble(R, A);
+    } else {
+      setInfinity(R);
+    }
+    return;
+  }
+
+  fpSqr(hh, h);
+  fpAdd(i, hh, hh);
+  fpAdd(i, i, i);
+  fpMul(j, h, i);
+  fpAdd(r, r, r);
+  fpMul(v, A.x, i);
+
+  /* 2 Y1 J and Z3 = (Z1 + H)^2 - Z1Z1 - HH, while A is still intact */
+  fpMul(s2, A.y, j);
+  fpAdd(s2, s2, s2);
+  fpAdd(t, A.z, h);
+  fpSqr(t, t);
+  fpSub(t, t, z1z1);
+  fpSub(R.z, t, hh);
+
+  /* X3 = r^2 - J - 2 V */
+  fpSqr(t, r);
+  fpSub(t, t, j);
+  fpSub(t, t, v);
+  fpSub(R.x, t, v);
+
+  /* Y3 = r (V - X3) - 2 Y1 J */
+  fpSub(t, v, R.x);
+  fpMul(t, r, t);
+  fpSub(R.y, t, s2);
+}
+
+/* add-2007-bl. R may be A or B */
+static void pointAdd(JacobianPoint & R, const JacobianPoint & A, const JacobianPoint & B)
+{
+  uint32_t z1z1[8], z2z2[8], u1[8], u2[8], s1[8], s2[8], h[8], i[8], j[8], r[8], v[8], t[8];
+
+  if (isZero(A.z)) {
+    R = B;
+    return;
+  }
+  if (isZero(B.z)) {
+    R = A;
+    return;
+  }
+
+  fpSqr(z1z1, A.z);
+  fpSqr(z2z2, B.z);
+  fpMul(u1, A.x, z2z2);
+  fpMul(u2, B.x, z1z1);
+  fpMul(s1, A.y, B.z);
+  fpMul(s1, s1, z2z2);
+  fpMul(s2, B.y, A.z);
+  fpMul(s2, s2, z1z1);
+  fpSub(h, u2, u1);
+  fpSub(r, s2, s1);
+
+  if (isZero(h)) {
+    if (isZero(r)) {
+      pointDouble(R, A);
+    } else {
+      setInfinity(R);
+    }
+    return;
+  }
+
+  fpAdd(i, h, h);
+  fpSqr(i, i);
+  fpMul(j, h, i);
+  fpAdd(r, r, r);
+  fpMul(v, u1, i);
+
+  /* Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) H */
+  fpAdd(t, A.z, B.z);
+  fpSqr(t, t);
+  fpSub(t, t, z1z1);
+  fpSub(t, t, z2z2);
+  fpMul(R.z, t, h);
+
+  /* X3 = r^2 - J - 2 V */
+  fpSqr(t, r);
+  fpSub(t, t, j);
+  fpSub(t, t, v);
+  fpSub(R.x, t, v);
+
+  /* Y3 = r (V - X3) - 2 S1 J */
+  fpMul(s1, s1, j);
+  fpAdd(s1, s1, s1);
+  fpSub(t, v, R.x);
+  fpMul(t, r, t);
+  fpSub(R.y, t, s1);
+}
+
+static void toAffine(uint32_t x[], uint32_t y[], const JacobianPoint & A)
+{
+  uint32_t zinv[8], zinv2[8];
+
+  montInv(zinv, A.z, P);
+  fpSqr(zinv2, zinv);
+  fpMul(x, A.x, zinv2);
+  fpMul(zinv2, zinv2, zinv);
+  fpMul(y, A.y, zinv2);
+}
+
+/* Bits i, i + 64, i + 128 and i + 192 of k, as a comb table index */
+static int combIndex(const uint32_t k[], int i)
+{
+  return ((k[i / 32] >> (i % 32)) & 1) |
+         (((k[(i + 64) / 32] >> (i % 32)) & 1) << 1) |
+         (((k[(i + 128) / 32] >> (i % 32)) & 1) << 2) |
+         (((k[(i + 192) / 32] >> (i % 32)) & 1) << 3);
+}
+
+/**************************************************************************************
+ * CTOR/DTOR
+ **************************************************************************************/
+
+SElementP256::SElementP256()
+: _ready {false}
+, _trusted {false}
+{
+  memset(_trustedKey, 0, sizeof(_trustedKey));
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementP256::begin()
+{
+  AffinePoint generator;
+
+  if (_ready) {
+    return 1;
+  }
+
+  if (!loadPublicKey(GENERATOR, generator)) {
+    return 0;
+  }
+  buildTable(generator, _generatorTable);
+  _ready = true;
+  return 1;
+}
+
+int SElementP256::setTrustedKey(const byte pubkey[])
+{
+  AffinePoint key;
+
+  _trusted = false;
+  if (!loadPublicKey(pubkey, key)) {
+    DEBUG_ERROR("SEP256::%s public key is not on the curve", __FUNCTION__);
+    return 0;
+  }
+
+  buildTable(key, _trustedTable);
+  memcpy(_trustedKey, pubkey, sizeof(_trustedKey));
+  _trusted = true;
+  return 1;
+}
+
+void SElementP256::clearTrustedKey()
+{
+  _trusted = false;
+}
+
+bool SElementP256::isTrustedKey(const byte pubkey[]) const
+{
+  return _trusted && memcmp(pubkey, _trustedKey, sizeof(_trustedKey)) == 0;
+}
+
+int SElementP256::verify(const byte message[], const byte signature[], const byte pubkey[])
+{
+  uint32_t r[8], s[8], e[8], w[8], u1[8], u2[8], t[8];
+  JacobianPoint R;
+
+  if (!begin()) {
+    return 0;
+  }
+
+  fromBytes(r, &signature[0]);
+  fromBytes(s, &signature[32]);
+  if (isZero(r) || isZero(s) || compare(r, N.m) >= 0 || compare(s, N.m) >= 0) {
+    DEBUG_VERBOSE("SEP256::%s signature out of range", __FUNCTION__);
+    return 0;
+  }
+
+  /* e < 2^256 < 2 n */
+  fromBytes(e, message);
+  if (compare(e, N.m) >= 0) {
+    sub(e, e, N.m);
+  }
+
+  /* w = s^-1 in Montgomery form, so u = x w / R is already plain */
+  montMul(w, s, N.rr, N);
+  montInv(w, w, N);
+  montMul(u1, e, w, N);
+  montMul(u2, r, w, N);
+
+  setInfinity(R);
+  if (isTrustedKey(pubkey)) {
+    /* Both combs share the doublings */
+    for (int i = 63; i >= 0; i--) {
+      pointDouble(R, R);
+      int index = combIndex(u1, i);
+      if (index) {
+        pointAddAffine(R, R, _generatorTable[index - 1].x, _generatorTable[index - 1].y);
+      }
+      index = combIndex(u2, i);
+      if (index) {
+        pointAddAffine(R, R, _trustedTable[index - 1].x, _trustedTable[index - 1].y);
+      }
+    }
+  } else {
+    AffinePoint key;
+    JacobianPoint window[15];
+    JacobianPoint Q;
+
+    if (!loadPublicKey(pubkey, key)) {
+      DEBUG_VERBOSE("SEP256::%s public key is not on the curve", __FUNCTION__);
+      return 0;
+    }
+
+    /* u2 Q with a 4 bit fixed window over 1 Q .. 15 Q */
+    setInfinity(window[0]);
+    pointAddAffine(window[0], window[0], key.x, key.y);
+    for (int i = 1; i < 15; i++) {
+      pointAddAffine(window[i], window[i - 1], key.x, key.y);
+    }
+
+    setInfinity(Q);
+    for (int i = 63; i >= 0; i--) {
+      for (int d = 0; d < 4; d++) {
+        pointDouble(Q, Q);
+      }
+      int index = (u2[i / 8] >> ((i % 8) * 4)) & 0x0f;
+      if (index) {
+        pointAdd(Q, Q, window[index - 1]);
+      }
+    }
+
+    for (int i = 63; i >= 0; i--) {
+      pointDouble(R, R);
+      int index = combIndex(u1, i);
+      if (index) {
+        pointAddAffine(R, R, _generatorTable[index - 1].x, _generatorTable[index - 1].y);
+      }
+    }
+    pointAdd(R, R, Q);
+  }
+
+  if (isZero(R.z)) {
+    return 0;
+  }
+
+  /* x(R) mod n == r, checked projectively as X == r Z^2, or (r + n) Z^2
+   * when r + n is still lower than p. Saves the field inversion.
+   */
+  uint32_t z2[8];
+  fpSqr(z2, R.z);
+  montMul(t, r, P.rr, P);
+  fpMul(t, t, z2);
+  if (isEqual(t, R.x)) {
+    return 1;
+  }
+
+  if (add(e, r, N.m) == 0 && compare(e, P.m) < 0) {
+    montMul(t, e, P.rr, P);
+    fpMul(t, t, z2);
+    if (isEqual(t, R.x)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementP256::loadPublicKey(const byte pubkey[], AffinePoint & point)
+{
+  uint32_t x[8], y[8], lhs[8], rhs[8], t[8];
+
+  fromBytes(x, &pubkey[0]);
+  fromBytes(y, &pubkey[32]);
+  if (compare(x, P.m) >= 0 || compare(y, P.m) >= 0) {
+    return 0;
+  }
+
+  montMul(point.x, x, P.rr, P);
+  montMul(point.y, y, P.rr, P);
+
+  /* y^2 == x^3 - 3 x + b */
+  fpSqr(lhs, point.y);
+  fpSqr(rhs, point.x);
+  fpMul(rhs, rhs, point.x);
+  fpAdd(t, point.x, point.x);
+  fpAdd(t, t, point.x);
+  fpSub(rhs, rhs, t);
+  montMul(t, CURVE_B, P.rr, P);
+  fpAdd(rhs, rhs, t);
+
+  return isEqual(lhs, rhs) ? 1 : 0;
+}
+
+void SElementP256::buildTable(const AffinePoint & base, AffinePoint table[])
+{
+  JacobianPoint teeth[4];
+  JacobianPoint entry;
+
+  /* teeth[j] = 2^(64 j) base */
+  setInfinity(teeth[0]);
+  pointAddAffine(teeth[0], teeth[0], base.x, base.y);
+  for (int j = 1; j < 4; j++) {
+    teeth[j] = teeth[j - 1];
+    for (int d = 0; d < 64; d++) {
+      pointDouble(teeth[j], teeth[j]);
+    }
+  }
+
+  /* table[index - 1] = sum of the teeth selected by the bits of index */
+  for (int index = 1; index <= SE_P256_COMB_POINTS; index++) {
+    setInfinity(entry);
+    for (int j = 0; j < 4; j++) {
+      if (index & (1 << j)) {
+        pointAdd(entry, entry, teeth[j]);
+      }
+    }
+    toAffine(table[index - 1].x, table[index - 1].y, entry);
+  }
+}
@@ -0,0 +1,79 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_P256_H_
+#define SECURE_ELEMENT_P256_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+/* Comb with 4 teeth: 15 precomputed points per base */
+#define SE_P256_COMB_POINTS 15
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+/* Software ECDSA P-256 verifier running on the MCU.
+ *
+ * Verification only handles public data, so the code is not constant time.
+ * Field arithmetic is Montgomery with 8 x 32 bit limbs on Jacobian points.
+ * The generator uses a fixed-base comb table built by begin(); a trusted
+ * key set with setTrustedKey() gets its own table, so both scalar products
+ * share the same 64 doublings. Other keys use a 4 bit window.
+ *
+ * Tables take about 2 KB of RAM. Attach it to a SecureElement with
+ * setVerifyPolicy() to route ecdsaVerify() to it.
+ */
+class SElementP256
+{
+public:
+
+  SElementP256();
+
+  /* Builds the generator table, verify() calls it when needed */
+  int begin();
+
+  int setTrustedKey(const byte pubkey[]);
+  void clearTrustedKey();
+  bool isTrustedKey(const byte pubkey[]) const;
+
+  /* Same arguments as SecureElement::ecdsaVerify(): 32 byte hash, raw
+   * r || s signature and raw X || Y public key. Returns 1 if valid.
+   */
+  int verify(const byte message[], const byte signature[], const byte pubkey[]);
+
+private:
+
+  /* Coordinates in Montgomery form, least significant limb first */
+  struct AffinePoint {
+    uint32_t x[8];
+    uint32_t y[8];
+  };
+
+  AffinePoint _generatorTable[SE_P256_COMB_POINTS];
+  AffinePoint _trustedTable[SE_P256_COMB_POINTS];
+  byte _trustedKey[64];
+  bool _ready;
+  bool _trusted;
+
+  static int loadPublicKey(const byte pubkey[], AffinePoint & point);
+  static void buildTable(const AffinePoint & base, AffinePoint table[]);
+
+};
+
+#endif /* SECURE_ELEMENT_P256_H_ */
@@ -0,0 +1,161 @@
+/*
+    This file is part of the Arduino_SecureElement library.
+
+    Copyright (c) 2024 Arduino SA
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <utility/SElementParser.h>
+
+namespace arduino { namespace parser {
+
+/* Nibble value of hex digits, 0xFF marks invalid characters */
+static const byte INVALID = 0xFF;
+static const byte HEX_TABLE[128] = {
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+     0,    1,    2,    3,    4,    5,    6,    7,    8,    9, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF,   10,   11,   12,   13,   14,   15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF,   10,   11,   12,   13,   14,   15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+static const byte DAYS_IN_MONTH[12] = {
+  31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+static inline byte nibble(char c) {
+  return ((byte)c < sizeof(HEX_TABLE)) ? HEX_TABLE[(byte)c] : INVALID;
+}
+
+/* Fixed width decimal field, -1 if any character is not a digit */
+static int digits(const char in[], int count) {
+  int value = 0;
+  for (int i = 0; i < count; i++) {
+    if (in[i] < '0' || in[i] > '9') {
+      return -1;
+    }
+    value = value * 10 + (in[i] - '0');
+  }
+  return value;
+}
+
+static bool isLeapYear(int year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int daysInMonth(int year, int month) {
+  return (month == 2 && isLeapYear(year)) ? 29 : DAYS_IN_MONTH[month - 1];
+}
+
+/* Days since 1970-01-01 of a proleptic Gregorian date and back */
+static long daysFromCivil(int year, int month, int day) {
+  year -= month <= 2;
+  long era = (year >= 0 ? year : year - 399) / 400;
+  long yoe = year - era * 400;
+  long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+static void civilFromDays(long days, DateTime & out) {
+  days += 719468;
+  long era = (days >= 0 ? days : days - 146096) / 146097;
+  long doe = days - era * 146097;
+  long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  long mp = (5 * doy + 2) / 153;
+  out.day = doy - (153 * mp + 2) / 5 + 1;
+  out.month = mp < 10 ? mp + 3 : mp - 9;
+  out.year = yoe + era * 400 + (out.month <= 2);
+}
+
+int hex(const char in[], size_t length, byte out[], size_t outLength) {
+  if (length != 2 * outLength) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < outLength; i++) {
+    byte high = nibble(in[2 * i]);
+    byte low = nibble(in[2 * i + 1]);
+    if (high == INVALID || low == INVALID) {
+      return -1;
+    }
+    out[i] = (high << 4) | low;
+  }
+
+  return outLength;
+}
+
+int rfc3339(const char in[], size_t length, DateTime & out) {
+  /* Shortest form is YYYY-MM-DDTHH:MM:SSZ */
+  if (length < 20 || in[4] != '-' || in[7] != '-' ||
+      (in[10] != 'T' && in[10] != 't' && in[10] != ' ') || in[13] != ':' || in[16] != ':') {
+    return 0;
+  }
+
+  out.year = digits(&in[0], 4);
+  out.month = digits(&in[5], 2);
+  out.day = digits(&in[8], 2);
+  out.hour = digits(&in[11], 2);
+  out.minute = digits(&in[14], 2);
+  out.second = digits(&in[17], 2);
+
+  if (out.year < 0 || out.month < 1 || out.month > 12 || out.day < 1 ||
+      out.day > daysInMonth(out.year, out.month) || out.hour < 0 || out.hour > 23 ||
+      out.minute < 0 || out.minute > 59 || out.second < 0 || out.second > 60) {
+    return 0;
+  }
+
+  size_t pos = 19;
+  if (in[pos] == '.') {
+    size_t start = ++pos;
+    while (pos < length && in[pos] >= '0' && in[pos] <= '9') {
+      pos++;
+    }
+    if (pos == start) {
+      return 0;
+    }
+  }
+
+  if (pos == length - 1 && (in[pos] == 'Z' || in[pos] == 'z')) {
+    return 1;
+  }
+
+  if (pos + 6 != length || (in[pos] != '+' && in[pos] != '-') || in[pos + 3] != ':') {
+    return 0;
+  }
+
+  int offsetHours = digits(&in[pos + 1], 2);
+  int offsetMinutes = digits(&in[pos + 4], 2);
+  if (offsetHours < 0 || offsetHours > 23 || offsetMinutes < 0 || offsetMinutes > 59) {
+    return 0;
+  }
+
+  /* Local time minus a positive offset is UTC, the date may roll over */
+  long offset = (in[pos] == '+' ? 1 : -1) * (offsetHours * 60L + offsetMinutes);
+  long minutes = out.hour * 60L + out.minute - offset;
+  long days = daysFromCivil(out.year, out.month, out.day);
+
+  while (minutes < 0) {
+    minutes += 24 * 60;
+    days--;
+  }
+  while (minutes >= 24 * 60) {
+    minutes -= 24 * 60;
+    days++;
+  }
+
+  civilFromDays(days, out);
+  out.hour = minutes / 60;
+  out.minute = minutes % 60;
+
+  return 1;
+}
+
+}} // arduino::parser
@@ -0,0 +1,41 @@
+/*
+    This file is part of the Arduino_SecureElement library.
+
+    Copyright (c) 2024 Arduino SA
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace arduino { namespace parser {
+
+    /* Strict parsers for provisioning metadata, working on character views
+     * that need not be NUL terminated and never allocating.
+     */
+
+    /* Decodes exactly 2 * outLength hex digits of either case. Returns
+     * outLength, or -1 on any other input length or a non hex character.
+     */
+    int hex(const char in[], size_t length, byte out[], size_t outLength);
+
+    struct DateTime {
+      int year;
+      int month;
+      int day;
+      int hour;
+      int minute;
+      int second;
+    };
+
+    /* RFC 3339 date-time, e.g. 2024-05-06T07:00:00Z. Fractional seconds are
+     * dropped and a numeric offset is applied, out is always UTC. Returns 1
+     * on success, 0 on malformed input or out of range fields.
+     */
+    int rfc3339(const char in[], size_t length, DateTime & out);
+
+}} // arduino::parser
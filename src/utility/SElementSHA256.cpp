@@ -0,0 +1,161 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <utility/SElementSHA256.h>
+
+/******************************************************************************
+ * LOCAL MODULE FUNCTIONS
+ ******************************************************************************/
+
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t ror(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+void SElementSHA256::begin()
+{
+  _state[0] = 0x6a09e667;
+  _state[1] = 0xbb67ae85;
+  _state[2] = 0x3c6ef372;
+  _state[3] = 0xa54ff53a;
+  _state[4] = 0x510e527f;
+  _state[5] = 0x9b05688c;
+  _state[6] = 0x1f83d9ab;
+  _state[7] = 0x5be0cd19;
+  _length = 0;
+  _blockLen = 0;
+}
+
+void SElementSHA256::update(const uint8_t * data, size_t length)
+{
+  _length += length;
+
+  if (_blockLen) {
+    size_t fill = SE_SHA256_BLOCK_LENGTH - _blockLen;
+    if (length < fill) {
+      memcpy(&_block[_blockLen], data, length);
+      _blockLen += length;
+      return;
+    }
+    memcpy(&_block[_blockLen], data, fill);
+    transform(_block);
+    data += fill;
+    length -= fill;
+    _blockLen = 0;
+  }
+
+  for (; length >= SE_SHA256_BLOCK_LENGTH; data += SE_SHA256_BLOCK_LENGTH, length -= SE_SHA256_BLOCK_LENGTH) {
+    transform(data);
+  }
+
+  memcpy(_block, data, length);
+  _blockLen = length;
+}
+
+void SElementSHA256::end(uint8_t digest[SE_SHA256_DIGEST_LENGTH])
+{
+  uint64_t bits = _length * 8;
+
+  _block[_blockLen++] = 0x80;
+  if (_blockLen > SE_SHA256_BLOCK_LENGTH - 8) {
+    memset(&_block[_blockLen], 0x00, SE_SHA256_BLOCK_LENGTH - _blockLen);
+    transform(_block);
+    _blockLen = 0;
+  }
+  memset(&_block[_blockLen], 0x00, SE_SHA256_BLOCK_LENGTH - 8 - _blockLen);
+  for (int i = 0; i < 8; i++) {
+    _block[SE_SHA256_BLOCK_LENGTH - 1 - i] = (uint8_t)(bits >> (8 * i));
+  }
+  transform(_block);
+
+  for (int i = 0; i < 8; i++) {
+    digest[4 * i + 0] = (uint8_t)(_state[i] >> 24);
+    digest[4 * i + 1] = (uint8_t)(_state[i] >> 16);
+    digest[4 * i + 2] = (uint8_t)(_state[i] >> 8);
+    digest[4 * i + 3] = (uint8_t)(_state[i]);
+  }
+}
+
+void SElementSHA256::sha256(const uint8_t * data, size_t length, uint8_t digest[SE_SHA256_DIGEST_LENGTH])
+{
+  SElementSHA256 ctx;
+  ctx.begin();
+  ctx.update(data, length);
+  ctx.end(digest);
+}
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+void SElementSHA256::transform(const uint8_t block[SE_SHA256_BLOCK_LENGTH])
+{
+  uint32_t w[16];
+  uint32_t a = _state[0];
+  uint32_t b = _state[1];
+  uint32_t c = _state[2];
+  uint32_t d = _state[3];
+  uint32_t e = _state[4];
+  uint32_t f = _state[5];
+  uint32_t g = _state[6];
+  uint32_t h = _state[7];
+
+  for (int i = 0; i < 64; i++) {
+    uint32_t x;
+    if (i < 16) {
+      x = ((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16) |
+          ((uint32_t)block[4 * i + 2] << 8) | (uint32_t)block[4 * i + 3];
+    } else {
+      uint32_t w15 = w[(i - 15) & 15];
+      uint32_t w2 = w[(i - 2) & 15];
+      x = w[i & 15] + (ror(w15, 7) ^ ror(w15, 18) ^ (w15 >> 3)) +
+          w[(i - 7) & 15] + (ror(w2, 17) ^ ror(w2, 19) ^ (w2 >> 10));
+    }
+    w[i & 15] = x;
+
+    uint32_t t1 = h + (ror(e, 6) ^ ror(e, 11) ^ ror(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + x;
+    uint32_t t2 = (ror(a, 2) ^ ror(a, 13) ^ ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  _state[0] += a;
+  _state[1] += b;
+  _state[2] += c;
+  _state[3] += d;
+  _state[4] += e;
+  _state[5] += f;
+  _state[6] += g;
+  _state[7] += h;
+}
@@ -0,0 +1,55 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_SHA256_H_
+#define SECURE_ELEMENT_SHA256_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+#define SE_SHA256_BLOCK_LENGTH   64
+#define SE_SHA256_DIGEST_LENGTH  32
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+/* Software SHA-256, used where data is public and a round trip to the secure
+ * element would cost more than hashing on the MCU (cache keys, streaming).
+ */
+class SElementSHA256
+{
+public:
+
+  void begin();
+  void update(const uint8_t * data, size_t length);
+  void end(uint8_t digest[SE_SHA256_DIGEST_LENGTH]);
+
+  static void sha256(const uint8_t * data, size_t length, uint8_t digest[SE_SHA256_DIGEST_LENGTH]);
+
+private:
+
+  uint32_t _state[8];
+  uint64_t _length;
+  uint8_t  _block[SE_SHA256_BLOCK_LENGTH];
+  size_t   _blockLen;
+
+  void transform(const uint8_t block[SE_SHA256_BLOCK_LENGTH]);
+
+};
+
+#endif /* SECURE_ELEMENT_SHA256_H_ */
@@ -0,0 +1,106 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <utility/SElementSlotWriter.h>
+
+/**************************************************************************************
+ * CTOR/DTOR
+ **************************************************************************************/
+
+SElementSlotWriter::SElementSlotWriter()
+{
+  begin();
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+void SElementSlotWriter::begin()
+{
+  _used = 0;
+  _count = 0;
+  _failedSlot = -1;
+}
+
+int SElementSlotWriter::stage(int slot, const byte data[], int length)
+{
+  if (_count >= SE_SLOT_WRITER_MAX_WRITES || length <= 0 || length > SE_SLOT_WRITER_BUFFER_LENGTH - _used) {
+    DEBUG_ERROR("SESW::%s writer full", __FUNCTION__);
+    return 0;
+  }
+
+  memcpy(&_buffer[_used], data, length);
+  _writes[_count].slot = slot;
+  _writes[_count].offset = _used;
+  _writes[_count].length = length;
+  _used += length;
+  _count++;
+  return 1;
+}
+
+int SElementSlotWriter::write(SecureElement & se, bool verify)
+{
+  _failedSlot = -1;
+
+  for (int i = 0; i < _count; i++) {
+    if (!se.writeSlot(_writes[i].slot, &_buffer[_writes[i].offset], _writes[i].length)) {
+      DEBUG_ERROR("SESW::%s write error on slot %d", __FUNCTION__, _writes[i].slot);
+      _failedSlot = _writes[i].slot;
+      return 0;
+    }
+  }
+
+  return verify ? readBack(se) : 1;
+}
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementSlotWriter::readBack(SecureElement & se)
+{
+  /* Read back into one heap buffer sized for the largest write, bounded by
+   * SE_SLOT_WRITER_BUFFER_LENGTH
+   */
+  int maxLength = 0;
+  for (int i = 0; i < _count; i++) {
+    if (_writes[i].length > maxLength) {
+      maxLength = _writes[i].length;
+    }
+  }
+
+  byte * data = (byte *)malloc(maxLength > 0 ? maxLength : 1);
+  if (data == nullptr) {
+    DEBUG_ERROR("SESW::%s out of memory", __FUNCTION__);
+    return 0;
+  }
+
+  for (int i = 0; i < _count; i++) {
+    if (!se.readSlot(_writes[i].slot, data, _writes[i].length)) {
+      DEBUG_ERROR("SESW::%s read error on slot %d", __FUNCTION__, _writes[i].slot);
+      _failedSlot = _writes[i].slot;
+      break;
+    }
+
+    if (memcmp(data, &_buffer[_writes[i].offset], _writes[i].length) != 0) {
+      DEBUG_ERROR("SESW::%s slot %d does not read back as staged", __FUNCTION__, _writes[i].slot);
+      _failedSlot = _writes[i].slot;
+      break;
+    }
+  }
+
+  free(data);
+  return _failedSlot < 0;
+}
@@ -0,0 +1,79 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_SLOT_WRITER_H_
+#define SECURE_ELEMENT_SLOT_WRITER_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino_SecureElement.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+#ifndef SE_SLOT_WRITER_MAX_WRITES
+  #define SE_SLOT_WRITER_MAX_WRITES    4
+#endif
+
+/* Total bytes that can be staged, a full DER certificate fits */
+#ifndef SE_SLOT_WRITER_BUFFER_LENGTH
+  #define SE_SLOT_WRITER_BUFFER_LENGTH SE_CERT_BUFFER_LENGTH
+#endif
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+/* Slot writes staged in RAM, written and verified with one pass/fail result.
+ *
+ * write() is not atomic: slots are written one after the other, so a reset
+ * or an error leaves the earlier slots written and the later ones not. Call
+ * write() again to repeat the whole sequence. With verify every slot is then
+ * read back in full and compared with the staged data. None of the drivers
+ * can hash slot contents on-chip, so this costs one read per slot, skip it
+ * when the caller checks the result another way.
+ */
+class SElementSlotWriter
+{
+public:
+
+  SElementSlotWriter();
+
+  void begin();
+  /* Copies data, returns 0 if the writer is full */
+  int  stage(int slot, const byte data[], int length);
+  inline int count() const { return _count; }
+
+  /* Returns 1 if every slot was written and, with verify, reads back as staged */
+  int  write(SecureElement & se, bool verify = true);
+  /* Slot that failed the last write(), -1 if none did */
+  inline int failedSlot() const { return _failedSlot; }
+
+private:
+
+  struct Write {
+    int slot;
+    int offset;
+    int length;
+  } _writes[SE_SLOT_WRITER_MAX_WRITES];
+
+  byte _buffer[SE_SLOT_WRITER_BUFFER_LENGTH];
+  int  _used;
+  int  _count;
+  int  _failedSlot;
+
+  int readBack(SecureElement & se);
+
+};
+
+#endif /* SECURE_ELEMENT_SLOT_WRITER_H_ */
@@ -0,0 +1,307 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <utility/SElementTLSKey.h>
+
+/******************************************************************************
+ * LOCAL MODULE FUNCTIONS
+ ******************************************************************************/
+
+/* ECDSA uses the leftmost 256 bits of longer hashes, shorter ones are
+ * taken as a big endian integer.
+ */
+static void hashToDigest(const byte hash[], size_t hashLength, byte digest[])
+{
+  if (hashLength >= SE_SHA256_BUFFER_LENGTH) {
+    memcpy(digest, hash, SE_SHA256_BUFFER_LENGTH);
+  } else {
+    size_t padding = SE_SHA256_BUFFER_LENGTH - hashLength;
+    memset(digest, 0, padding);
+    memcpy(&digest[padding], hash, hashLength);
+  }
+}
+
+#if defined(SE_TLS_KEY_MBEDTLS)
+static size_t mbedTLSGetBitlen(const void * ctx)
+{
+  (void)ctx;
+  return 256;
+}
+
+static int mbedTLSCanDo(mbedtls_pk_type_t type)
+{
+  return type == MBEDTLS_PK_ECKEY || type == MBEDTLS_PK_ECDSA;
+}
+
+static int mbedTLSSign(void * ctx, mbedtls_md_type_t md_alg, const unsigned char * hash, size_t hash_len,
+                       unsigned char * sig, size_t * sig_len,
+                       int (*f_rng)(void *, unsigned char *, size_t), void * p_rng)
+{
+  SElementTLSKeyMbedTLSContext * context = (SElementTLSKeyMbedTLSContext *)ctx;
+  /* The hash is signed as is and the nonce comes from the secure element */
+  (void)md_alg;
+  (void)f_rng;
+  (void)p_rng;
+
+  int length = context->key->sign(hash, hash_len, sig, SE_TLS_KEY_DER_SIGNATURE_MAX_LENGTH);
+  if (!length) {
+    return MBEDTLS_ERR_PK_HW_ACCEL_FAILED;
+  }
+  *sig_len = length;
+  return 0;
+}
+
+static int mbedTLSVerify(void * ctx, mbedtls_md_type_t md_alg, const unsigned char * hash, size_t hash_len,
+                         const unsigned char * sig, size_t sig_len)
+{
+  SElementTLSKeyMbedTLSContext * context = (SElementTLSKeyMbedTLSContext *)ctx;
+  (void)md_alg;
+
+  return context->key->verify(hash, hash_len, sig, sig_len) ? 0 : MBEDTLS_ERR_ECP_VERIFY_FAILED;
+}
+
+/* mbedtls_pk_free() always calls it, the context belongs to the SElementTLSKey */
+static void mbedTLSFree(void * ctx)
+{
+  SElementTLSKeyMbedTLSContext * context = (SElementTLSKeyMbedTLSContext *)ctx;
+
+  mbedtls_ecp_keypair_free(&context->keypair);
+  context->key = nullptr;
+}
+
+static mbedtls_pk_info_t mbedTLSInfo;
+#endif
+
+#if defined(SE_TLS_KEY_BEARSSL)
+static SElementTLSKey * bearSSLKey = nullptr;
+
+/* Names the curve only, BearSSL must never use it for ECDH (BR_KEYTYPE_KEYX) */
+static const br_ec_private_key bearSSLPlaceholderKey = { BR_EC_secp256r1, nullptr, 0 };
+#endif
+
+/**************************************************************************************
+ * CTOR/DTOR
+ **************************************************************************************/
+
+SElementTLSKey::SElementTLSKey(SecureElement & se, int slot)
+: _se {se}
+, _slot {slot}
+{
+  memset(_publicKey, 0, sizeof(_publicKey));
+#if defined(SE_TLS_KEY_MBEDTLS)
+  _mbedTLSContext.key = nullptr;
+#endif
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementTLSKey::begin()
+{
+  if (!_se.generatePublicKey(_slot, _publicKey)) {
+    DEBUG_ERROR("SETLS::%s cannot read public key from slot %d", __FUNCTION__, _slot);
+    return 0;
+  }
+  return 1;
+}
+
+int SElementTLSKey::sign(const byte hash[], size_t hashLength, byte der[], size_t derLength)
+{
+  byte digest[SE_SHA256_BUFFER_LENGTH];
+  byte signature[ECP256_CERT_SIGNATURE_LENGTH];
+
+  hashToDigest(hash, hashLength, digest);
+
+  if (!_se.ecSign(_slot, digest, signature)) {
+    DEBUG_ERROR("SETLS::%s sign failed on slot %d", __FUNCTION__, _slot);
+    return 0;
+  }
+
+  return signatureToDER(signature, der, derLength);
+}
+
+int SElementTLSKey::verify(const byte hash[], size_t hashLength, const byte der[], size_t derLength)
+{
+  byte digest[SE_SHA256_BUFFER_LENGTH];
+  byte signature[ECP256_CERT_SIGNATURE_LENGTH];
+
+  if (!signatureFromDER(der, derLength, signature)) {
+    return 0;
+  }
+  hashToDigest(hash, hashLength, digest);
+
+  return _se.ecdsaVerify(digest, signature, _publicKey);
+}
+
+int SElementTLSKey::signatureToDER(const byte raw[], byte der[], size_t derLength)
+{
+  byte tmp[SE_TLS_KEY_DER_SIGNATURE_MAX_LENGTH];
+
+  int length = appendInteger(&raw[0], &tmp[2]);
+  length += appendInteger(&raw[32], &tmp[2 + length]);
+
+  if (derLength < (size_t)(length + 2)) {
+    DEBUG_ERROR("SETLS::%s output buffer too small", __FUNCTION__);
+    return 0;
+  }
+
+  /* At most 70 bytes, short form length */
+  tmp[0] = 0x30;
+  tmp[1] = length;
+  memcpy(der, tmp, length + 2);
+  return length + 2;
+}
+
+int SElementTLSKey::signatureFromDER(const byte der[], size_t derLength, byte raw[])
+{
+  if (derLength < 8 || der[0] != 0x30 || der[1] != derLength - 2) {
+    DEBUG_VERBOSE("SETLS::%s invalid sequence", __FUNCTION__);
+    return 0;
+  }
+
+  size_t offset = 2;
+  for (int i = 0; i < 2; i++) {
+    if (offset + 2 > derLength || der[offset] != 0x02 || der[offset + 1] > derLength - offset - 2) {
+      DEBUG_VERBOSE("SETLS::%s invalid integer", __FUNCTION__);
+      return 0;
+    }
+    if (!readInteger(&der[offset + 2], der[offset + 1], &raw[i * 32])) {
+      DEBUG_VERBOSE("SETLS::%s invalid integer", __FUNCTION__);
+      return 0;
+    }
+    offset += 2 + der[offset + 1];
+  }
+
+  return offset == derLength ? ECP256_CERT_SIGNATURE_LENGTH : 0;
+}
+
+#if defined(SE_TLS_KEY_MBEDTLS)
+int SElementTLSKey::setupMbedTLS(mbedtls_pk_context * pk)
+{
+  byte point[1 + ECP256_CERT_PUBLIC_KEY_LENGTH];
+
+  if (pk == nullptr || pk->pk_info != nullptr) {
+    DEBUG_ERROR("SETLS::%s pk context must be initialized and empty", __FUNCTION__);
+    return 0;
+  }
+
+  if (mbedTLSInfo.name == nullptr) {
+    memset(&mbedTLSInfo, 0, sizeof(mbedTLSInfo));
+    mbedTLSInfo.type = MBEDTLS_PK_ECKEY;
+    mbedTLSInfo.name = "SE_EC";
+    mbedTLSInfo.get_bitlen = mbedTLSGetBitlen;
+    mbedTLSInfo.can_do = mbedTLSCanDo;
+    mbedTLSInfo.verify_func = mbedTLSVerify;
+    mbedTLSInfo.sign_func = mbedTLSSign;
+    mbedTLSInfo.ctx_free_func = mbedTLSFree;
+  }
+
+  if (_mbedTLSContext.key != nullptr) {
+    DEBUG_ERROR("SETLS::%s key already in use, free its pk context first", __FUNCTION__);
+    return 0;
+  }
+
+  point[0] = 0x04;
+  memcpy(&point[1], _publicKey, ECP256_CERT_PUBLIC_KEY_LENGTH);
+
+  mbedtls_ecp_keypair_init(&_mbedTLSContext.keypair);
+  if (mbedtls_ecp_group_load(&_mbedTLSContext.keypair.grp, MBEDTLS_ECP_DP_SECP256R1) != 0 ||
+      mbedtls_ecp_point_read_binary(&_mbedTLSContext.keypair.grp, &_mbedTLSContext.keypair.Q, point, sizeof(point)) != 0) {
+    DEBUG_ERROR("SETLS::%s cannot load public key", __FUNCTION__);
+    mbedtls_ecp_keypair_free(&_mbedTLSContext.keypair);
+    return 0;
+  }
+  _mbedTLSContext.key = this;
+
+  pk->pk_info = &mbedTLSInfo;
+  pk->pk_ctx = &_mbedTLSContext;
+  return 1;
+}
+#endif
+
+#if defined(SE_TLS_KEY_BEARSSL)
+void SElementTLSKey::setupBearSSLClient(br_ssl_client_context * cc, const br_x509_certificate * chain, size_t chainLength,
+                                        unsigned certIssuerKeyType)
+{
+  bearSSLKey = this;
+  br_ssl_client_set_single_ec(cc, chain, chainLength, &bearSSLPlaceholderKey, BR_KEYTYPE_SIGN,
+                              certIssuerKeyType, br_ec_get_default(), bearSSLSign);
+}
+
+void SElementTLSKey::setupBearSSLServer(br_ssl_server_context * cc, const br_x509_certificate * chain, size_t chainLength,
+                                        unsigned certIssuerKeyType)
+{
+  bearSSLKey = this;
+  br_ssl_server_set_single_ec(cc, chain, chainLength, &bearSSLPlaceholderKey, BR_KEYTYPE_SIGN,
+                              certIssuerKeyType, br_ec_get_default(), bearSSLSign);
+}
+
+size_t SElementTLSKey::bearSSLSign(const br_ec_impl * impl, const br_hash_class * hf, const void * hash_value,
+                                   const br_ec_private_key * sk, void * sig)
+{
+  /* Signing happens in the secure element, not in impl */
+  (void)impl;
+
+  if (bearSSLKey == nullptr || sk != &bearSSLPlaceholderKey) {
+    DEBUG_ERROR("SETLS::%s no key bound", __FUNCTION__);
+    return 0;
+  }
+
+  size_t hashLength = (hf->desc >> BR_HASHDESC_OUT_OFF) & BR_HASHDESC_OUT_MASK;
+  return bearSSLKey->sign((const byte *)hash_value, hashLength, (byte *)sig, SE_TLS_KEY_DER_SIGNATURE_MAX_LENGTH);
+}
+#endif
+
+/******************************************************************************
+ * PRIVATE MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementTLSKey::appendInteger(const byte value[], byte out[])
+{
+  int start = 0;
+
+  /* Minimal encoding, keeping one byte for zero */
+  while (start < 31 && value[start] == 0x00) {
+    start++;
+  }
+
+  int length = 32 - start;
+  int pad = (value[start] & 0x80) ? 1 : 0;
+
+  out[0] = 0x02;
+  out[1] = length + pad;
+  out[2] = 0x00;
+  memcpy(&out[2 + pad], &value[start], length);
+  return 2 + pad + length;
+}
+
+int SElementTLSKey::readInteger(const byte in[], size_t length, byte out[])
+{
+  /* Positive and at most 256 bits, redundant leading zeros are tolerated */
+  if (length == 0 || (in[0] & 0x80)) {
+    return 0;
+  }
+  while (length > 32) {
+    if (in[0] != 0x00) {
+      return 0;
+    }
+    in++;
+    length--;
+  }
+
+  memset(out, 0, 32 - length);
+  memcpy(&out[32 - length], in, length);
+  return 1;
+}
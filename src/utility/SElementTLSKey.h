@@ -0,0 +1,132 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_TLS_KEY_H_
+#define SECURE_ELEMENT_TLS_KEY_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino_SecureElement.h>
+
+/* TLS stack glue is compiled only for the stacks the sketch can include:
+ * include the TLS library before this header.
+ */
+#if defined(__has_include)
+  /* The opaque key needs mbedtls_pk_info_t, private API of mbedTLS 2.x */
+  #if __has_include(<mbedtls/version.h>) && __has_include(<mbedtls/pk_internal.h>)
+    #include <mbedtls/version.h>
+    #if MBEDTLS_VERSION_NUMBER < 0x03000000
+      #include <mbedtls/pk.h>
+      #include <mbedtls/pk_internal.h>
+      #include <mbedtls/ecp.h>
+      #define SE_TLS_KEY_MBEDTLS
+    #endif
+  #endif
+  #if __has_include(<bearssl/bearssl.h>)
+    #include <bearssl/bearssl.h>
+    #define SE_TLS_KEY_BEARSSL
+  #elif __has_include(<bearssl.h>)
+    #include <bearssl.h>
+    #define SE_TLS_KEY_BEARSSL
+  #endif
+#endif
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+/* SEQUENCE of two INTEGERs of up to 33 bytes */
+#define SE_TLS_KEY_DER_SIGNATURE_MAX_LENGTH 72
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+class SElementTLSKey;
+
+#if defined(SE_TLS_KEY_MBEDTLS)
+/* Starts with a keypair holding the public key, so mbedtls_pk_ec() works on
+ * it like on a software key.
+ */
+struct SElementTLSKeyMbedTLSContext
+{
+  mbedtls_ecp_keypair keypair;
+  SElementTLSKey * key;
+};
+#endif
+
+/* ECDSA P-256 key in a secure element slot, usable as a TLS private key.
+ *
+ * With mbedTLS 2.x setupMbedTLS() turns a mbedtls_pk_context into an opaque
+ * key that signs through the secure element, and also carries the public key
+ * so curve checks done by the TLS stack work. Each SElementTLSKey can back
+ * one pk context at a time and must outlive it. With BearSSL,
+ * setupBearSSLClient() or setupBearSSLServer() install the key for ECDSA
+ * signing only (BR_KEYTYPE_SIGN): the secret never leaves the slot, so the
+ * static ECDH cipher suites (BR_KEYTYPE_KEYX) cannot use it. BearSSL sign
+ * callbacks carry no context, so only one BearSSL key can exist per
+ * program: the last setup call wins.
+ *
+ * Signing is synchronous, as the secure element drivers are blocking.
+ */
+class SElementTLSKey
+{
+public:
+
+  SElementTLSKey(SecureElement & se, int slot);
+
+  /* Reads the public key of the slot */
+  int begin();
+
+  inline int slot() const { return _slot; }
+  inline const byte * publicKey() const { return _publicKey; }
+
+  /* Signs a hash of any length, converted to 256 bits as ECDSA requires,
+   * and writes the DER signature. Returns its length or 0 on error.
+   */
+  int sign(const byte hash[], size_t hashLength, byte der[], size_t derLength);
+  int verify(const byte hash[], size_t hashLength, const byte der[], size_t derLength);
+
+  /* Raw r || s to DER and back, returning the output length or 0 */
+  static int signatureToDER(const byte raw[], byte der[], size_t derLength);
+  static int signatureFromDER(const byte der[], size_t derLength, byte raw[]);
+
+#if defined(SE_TLS_KEY_MBEDTLS)
+  /* pk must be initialized and empty, mbedtls_pk_free() releases it */
+  int setupMbedTLS(mbedtls_pk_context * pk);
+#endif
+
+#if defined(SE_TLS_KEY_BEARSSL)
+  /* Binds this key and calls br_ssl_*_set_single_ec() with BR_KEYTYPE_SIGN */
+  void setupBearSSLClient(br_ssl_client_context * cc, const br_x509_certificate * chain, size_t chainLength,
+                          unsigned certIssuerKeyType);
+  void setupBearSSLServer(br_ssl_server_context * cc, const br_x509_certificate * chain, size_t chainLength,
+                          unsigned certIssuerKeyType);
+  static size_t bearSSLSign(const br_ec_impl * impl, const br_hash_class * hf, const void * hash_value,
+                            const br_ec_private_key * sk, void * sig);
+#endif
+
+private:
+
+  SecureElement & _se;
+  int  _slot;
+  byte _publicKey[ECP256_CERT_PUBLIC_KEY_LENGTH];
+#if defined(SE_TLS_KEY_MBEDTLS)
+  SElementTLSKeyMbedTLSContext _mbedTLSContext;
+#endif
+
+  static int appendInteger(const byte value[], byte out[]);
+  static int readInteger(const byte in[], size_t length, byte out[]);
+
+};
+
+#endif /* SECURE_ELEMENT_TLS_KEY_H_ */
@@ -0,0 +1,112 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <utility/SElementVerifyCache.h>
+#include <ECP256Certificate.h>
+
+/**************************************************************************************
+ * CTOR/DTOR
+ **************************************************************************************/
+
+SElementVerifyCache::SElementVerifyCache()
+{
+  clear();
+  resetStats();
+}
+
+/******************************************************************************
+ * PUBLIC MEMBER FUNCTIONS
+ ******************************************************************************/
+
+int SElementVerifyCache::lookup(const byte message[], const byte signature[], const byte pubkey[])
+{
+  byte key[SE_SHA256_DIGEST_LENGTH];
+  computeKey(message, signature, pubkey, key);
+  return lookup(key);
+}
+
+void SElementVerifyCache::insert(const byte message[], const byte signature[], const byte pubkey[])
+{
+  byte key[SE_SHA256_DIGEST_LENGTH];
+  computeKey(message, signature, pubkey, key);
+  insert(key);
+}
+
+int SElementVerifyCache::lookup(const byte key[])
+{
+  for (int i = 0; i < SE_VERIFY_CACHE_ENTRIES; i++) {
+    if (_entries[i].valid && memcmp(_entries[i].key, key, SE_SHA256_DIGEST_LENGTH) == 0) {
+      _entries[i].lastUse = ++_tick;
+      _hits++;
+      return 1;
+    }
+  }
+  _misses++;
+  return 0;
+}
+
+void SElementVerifyCache::insert(const byte key[])
+{
+  int victim = 0;
+
+  for (int i = 0; i < SE_VERIFY_CACHE_ENTRIES; i++) {
+    if (!_entries[i].valid) {
+      victim = i;
+      break;
+    }
+    if (_entries[i].lastUse < _entries[victim].lastUse) {
+      victim = i;
+    }
+  }
+
+  if (_entries[victim].valid) {
+    _evictions++;
+  }
+
+  memcpy(_entries[victim].key, key, SE_SHA256_DIGEST_LENGTH);
+  _entries[victim].lastUse = ++_tick;
+  _entries[victim].valid = true;
+}
+
+void SElementVerifyCache::clear()
+{
+  memset(_entries, 0x00, sizeof(_entries));
+  _tick = 0;
+}
+
+int SElementVerifyCache::hitRate() const
+{
+  uint32_t total = _hits + _misses;
+  if (total == 0) {
+    return 0;
+  }
+  return (int)(((uint64_t)_hits * 100) / total);
+}
+
+void SElementVerifyCache::resetStats()
+{
+  _hits = 0;
+  _misses = 0;
+  _evictions = 0;
+}
+
+void SElementVerifyCache::computeKey(const byte message[], const byte signature[], const byte pubkey[], byte key[])
+{
+  SElementSHA256 sha;
+  sha.begin();
+  sha.update(pubkey, ECP256_CERT_PUBLIC_KEY_LENGTH);
+  sha.update(message, SE_SHA256_DIGEST_LENGTH);
+  sha.update(signature, ECP256_CERT_SIGNATURE_LENGTH);
+  sha.end(key);
+}
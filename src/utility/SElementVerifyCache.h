@@ -0,0 +1,80 @@
+/*
+  This file is part of the Arduino_SecureElement library.
+
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SECURE_ELEMENT_VERIFY_CACHE_H_
+#define SECURE_ELEMENT_VERIFY_CACHE_H_
+
+/******************************************************************************
+ * INCLUDE
+ ******************************************************************************/
+
+#include <Arduino.h>
+#include <utility/SElementSHA256.h>
+
+/******************************************************************************
+ * DEFINE
+ ******************************************************************************/
+
+#ifndef SE_VERIFY_CACHE_ENTRIES
+  #define SE_VERIFY_CACHE_ENTRIES 8
+#endif
+
+ /******************************************************************************
+ * CLASS DECLARATION
+ ******************************************************************************/
+
+/* Fixed-size LRU cache of successful ecdsaVerify() results.
+ *
+ * Entries are keyed by SHA-256(publicKey || message || signature), so a hit
+ * means the very same triple was already accepted by the secure element.
+ * Only positive results are stored: failures are never cached and always go
+ * to the chip again. Attach it with SecureElement::setVerifyCache(), detach
+ * it with setVerifyCache(nullptr).
+ */
+class SElementVerifyCache
+{
+public:
+
+  SElementVerifyCache();
+
+  int  lookup(const byte message[], const byte signature[], const byte pubkey[]);
+  void insert(const byte message[], const byte signature[], const byte pubkey[]);
+  /* Same, with a key from computeKey(): a miss followed by an insert
+   * hashes the triple only once.
+   */
+  int  lookup(const byte key[]);
+  void insert(const byte key[]);
+  void clear();
+
+  inline uint32_t hits() const { return _hits; }
+  inline uint32_t misses() const { return _misses; }
+  inline uint32_t evictions() const { return _evictions; }
+  /* Hit rate in percent, 0 when the cache was never queried */
+  int hitRate() const;
+  void resetStats();
+
+  static void computeKey(const byte message[], const byte signature[], const byte pubkey[], byte key[]);
+
+private:
+
+  struct Entry {
+    byte     key[SE_SHA256_DIGEST_LENGTH];
+    uint32_t lastUse;
+    bool     valid;
+  } _entries[SE_VERIFY_CACHE_ENTRIES];
+
+  uint32_t _tick;
+  uint32_t _hits;
+  uint32_t _misses;
+  uint32_t _evictions;
+
+};
+
+#endif /* SECURE_ELEMENT_VERIFY_CACHE_H_ */